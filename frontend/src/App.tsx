@@ -1,15 +1,18 @@
-import { useState, useEffect } from 'react'
+import { useState, useEffect, useRef } from 'react'
 import { Button } from '@/components/ui/button'
 import { Card, CardContent } from '@/components/ui/card'
 import { Input } from '@/components/ui/input'
 import { Label } from '@/components/ui/label'
 import { Select, SelectContent, SelectItem, SelectTrigger, SelectValue } from '@/components/ui/select'
-import { Play, FastForward } from 'lucide-react'
+import { Play, FastForward, Pause, Square } from 'lucide-react'
 import './App.css'
-import AdjacencyGraphViewer from './components/graph/AdjacencyGraphViewer'
+import AdjacencyGraphViewer, { type CsrAdjacency, type IndexedColoring } from './components/graph/AdjacencyGraphViewer'
+
+// Outcome of runColorReduction, shown in the result modal once a reduction has run
+type ColorReductionSummary = { bestColors: number, iterations: number, runs: number }
 
 // Simple Modal implementation
-function ResultModal({ open, onClose, conflicts, iterations, onGreedyRemove }: { open: boolean, onClose: () => void, conflicts: number, iterations: string, onGreedyRemove: () => void }) {
+function ResultModal({ open, onClose, conflicts, iterations, reduction, onGreedyRemove, onReduceColors }: { open: boolean, onClose: () => void, conflicts: number, iterations: string, reduction: ColorReductionSummary | null, onGreedyRemove: () => void, onReduceColors: () => void }) {
   if (!open) return null;
   return (
     <div style={{ position: 'fixed', top: 0, left: 0, width: '100vw', height: '100vh', background: 'rgba(0,0,0,0.3)', zIndex: 1000, display: 'flex', alignItems: 'center', justifyContent: 'center' }}>
@@ -21,9 +24,21 @@ function ResultModal({ open, onClose, conflicts, iterations, onGreedyRemove }: {
         <div style={{ marginBottom: 12 }}>
           <span>Conflicts: </span><b>{conflicts}</b>
         </div>
+        {reduction && (
+          <div style={{ marginBottom: 12 }}>
+            <span>Color reduction: </span><b>{reduction.bestColors} colors</b>
+            <span> after {reduction.iterations} iterations in {reduction.runs} runs</span>
+          </div>
+        )}
         <div style={{ marginBottom: 20 }}>
           {conflicts === 0 ? (
-            <span style={{ color: 'green', fontWeight: 500 }}>No conflicts! Coloring is valid.</span>
+            <div>
+              <span style={{ color: 'green', fontWeight: 500 }}>No conflicts! Coloring is valid.</span>
+              <div style={{ marginTop: 10 }}>
+                <span>Would you like to search for a valid coloring with fewer colors?</span>
+                <Button onClick={onReduceColors} className="w-full mt-2">Reduce Colors</Button>
+              </div>
+            </div>
           ) : (
             <div>
               <span style={{ color: 'red', fontWeight: 500 }}>Conflicts remain.</span>
@@ -39,16 +54,85 @@ function ResultModal({ open, onClose, conflicts, iterations, onGreedyRemove }: {
     </div>
   );
 }
-import factory, { type MainModule, type StateNode, type AlgorithmStartupOptions, type Graph, type ColorPalette, type ColoringMap } from "../../build/GraphColoring.js"
+import factory, { type MainModule, type StateNode, type AlgorithmStartupOptions, type Graph, type ColorPalette, type VectorInt } from "../../build/GraphColoring.js"
 
 type AlgorithmState = {
   graph: Graph, // retained for algorithms, but not needed for visualization anymore
   conflicts: number,
   lastUsedColor: number,
   palette: ColorPalette,
-  coloringMap: ColoringMap
-  adjacency: number[][],
-  colorArray: { index: number; r: number; g: number; b: number; }[]
+  coloringMap: VectorInt
+  adjacency: CsrAdjacency,
+  coloring: IndexedColoring,
+}
+
+// The getters return typed-array views straight over WASM memory, which the module's memory
+// growth detaches. Everything kept in React state (and the reset snapshot) is therefore a
+// JS-owned copy, sliced out right after the call.
+function readAdjacency(module: MainModule, graph: Graph | null): CsrAdjacency {
+  return {
+    offsets: (module.getGraphOffsets(graph) as Uint32Array).slice(),
+    targets: (module.getGraphTargets(graph) as Uint32Array).slice(),
+  };
+}
+
+// Result of algorithmStepN: `changes` holds (vertex, oldColor, newColor, conflictsAfter) records
+type StepDelta = {
+  changes: Int32Array,
+  steps: number,
+  conflicts: number,
+  color: number,
+  continueIteration: boolean,
+}
+
+function readColoring(module: MainModule, initial = false): IndexedColoring {
+  return {
+    indices: ((initial ? module.getInitialColorIndices() : module.getCurrentColorIndices()) as Int32Array).slice(),
+    palette: (module.getPaletteRGB() as Uint8Array).slice(),
+  };
+}
+
+// Word offsets of the background run's progress channel header (ProgressWord in
+// wasm/background_solver.h); the ring follows the header
+const Progress = {
+  WriteIndex: 0,
+  ReadIndex: 1,
+  Status: 4,
+  Iteration: 5,
+  Conflicts: 6,
+  Capacity: 8,
+  HeaderWords: 9,
+} as const;
+
+// SolverStatus in wasm/background_solver.h
+const SolverStatus = { Running: 0, Paused: 1, Finished: 2, Cancelled: 3, Failed: 4 } as const;
+
+// Drain every message published since the last call straight from shared memory (Atomics only,
+// no call into the module): apply its change records to `indices` and return them concatenated,
+// in the (vertex, oldColor, newColor, conflictsAfter) layout the viewer already understands.
+// Ring indices are int32 word counts that wrap, hence the `| 0`.
+function drainProgress(channel: Int32Array, indices: Int32Array): Int32Array {
+  const capacity = channel[Progress.Capacity];
+  const mask = capacity - 1;
+  let read = Atomics.load(channel, Progress.ReadIndex);
+  const write = Atomics.load(channel, Progress.WriteIndex);
+  const changes: number[] = [];
+  while (read !== write) {
+    const slot = Progress.HeaderWords + (read & mask);
+    const length = channel[slot];
+    if (length === -1) {
+      // wrap marker: the next message starts at the beginning of the ring
+      read = (read + capacity - (read & mask)) | 0;
+      continue;
+    }
+    for (let i = slot + 4; i < slot + length; i += 4) {
+      indices[channel[i]] = channel[i + 2];
+      changes.push(channel[i], channel[i + 1], channel[i + 2], channel[i + 3]);
+    }
+    read = (read + length) | 0;
+  }
+  Atomics.store(channel, Progress.ReadIndex, read);
+  return Int32Array.from(changes);
 }
 
 function App() {
@@ -59,21 +143,33 @@ function App() {
   const [algorithmState, setAlgorithmState] = useState<AlgorithmState | null>(null);
   const [wasmModule, setWasmModule] = useState<MainModule | null>(null)
   const [algorithmName, setAlgorithmName] = useState<string>('hill_climbing');
+  const [annealingSchedule, setAnnealingSchedule] = useState<string>('geometric');
+  const [initialColoring, setInitialColoring] = useState<string>('random');
+  const [oneColorFewer, setOneColorFewer] = useState(false);
+  const [kempeChains, setKempeChains] = useState(false);
+  const [vertexOrder, setVertexOrder] = useState<string>('original');
+  const [peel, setPeel] = useState(false);
   const [showResultModal, setShowResultModal] = useState(false);
+  const [colorReduction, setColorReduction] = useState<ColorReductionSummary | null>(null);
   const [finished, setFinished] = useState(false);
   // Store a copy of the initial coloring + adjacency so we can restore on reset
   const [initialSnapshot, setInitialSnapshot] = useState<AlgorithmState | null>(null);
   const [algorithmReady, setAlgorithmReady] = useState(false);
   const [currentStep, setCurrentStep] = useState(0);
+  // Set while the search runs on a solver thread; `paused` mirrors the solver's own status
+  const [backgroundRun, setBackgroundRun] = useState<{ paused: boolean } | null>(null);
+  const backgroundFrame = useRef(0);
 
   // Derived: number of distinct colors currently used in coloring
   const usedColorCount = (() => {
     if (!algorithmState) return 0;
-    const set = new Set<number>();
-    for (const c of algorithmState.colorArray) {
-      if (c.index !== -1) set.add(c.index);
+    const { indices, palette } = algorithmState.coloring;
+    const seen = new Uint8Array(palette.length / 3);
+    let count = 0;
+    for (const c of indices) {
+      if (c >= 0 && !seen[c]) { seen[c] = 1; count++; }
     }
-    return set.size;
+    return count;
   })();
 
   // Load WASM module once
@@ -88,39 +184,51 @@ function App() {
     }
   }
 
+  const startupOptions = (): AlgorithmStartupOptions => ({
+    algorithmName,
+    iterations: Number(iterations),
+    generationOptions: {
+      numVertices: vertices,
+      numEdges: edges,
+      allowSelfLoops: false,
+    },
+    annealingSchedule,
+    initialColoring,
+    oneColorFewer: initialColoring !== 'random' && oneColorFewer,
+    kempeChains,
+    vertexOrder,
+    peel: initialColoring !== 'random' && peel,
+  })
+
   const generateInitialState = () => {
     if (!wasmModule) return
     // Set initial algorithm state in WASM
-    const startupOptions: AlgorithmStartupOptions = {
-      algorithmName,
-      iterations: Number(iterations),
-      generationOptions: {
-        numVertices: vertices,
-        numEdges: edges,
-        allowSelfLoops: false,
-      }
+    wasmModule.setInitialAlgorithmState(startupOptions())
+    adoptInitialState()
+  }
+
+  // Parse a DIMACS .col or edge-list file inside WASM; only the raw bytes cross over
+  const loadGraphFromFile = async (file: File) => {
+    if (!wasmModule) return
+    try {
+      const bytes = new Uint8Array(await file.arrayBuffer())
+      wasmModule.setInitialAlgorithmStateFromBytes(startupOptions(), bytes)
+      adoptInitialState()
+    } catch (e) {
+      console.error(e)
     }
-    wasmModule.setInitialAlgorithmState(startupOptions)
+  }
+
+  const adoptInitialState = () => {
+    if (!wasmModule) return
     const stateNode: StateNode | null = wasmModule.getInitialStateNode()
     if (!stateNode) return
-    // Extract graph nodes
-    const graph = stateNode.graph
+    // Colorings are reported on the original graph even when the search runs on a reordered or peeled one
+    const graph = wasmModule.getDisplayGraph()
     console.log("Generated graph:", graph);
-    // Build adjacency & color arrays from C++ helpers
-    const adjacencyVal = wasmModule.getGraphAdjacency(graph);
-    const adjacency: number[][] = [];
-    for (let i = 0; i < adjacencyVal.length; i++) {
-      const row = adjacencyVal[i];
-      const inner: number[] = [];
-      for (let j = 0; j < row.length; j++) inner.push(row[j]);
-      adjacency.push(inner);
-    }
-    const colorArrayVal = wasmModule.getInitialColorArray();
-    const colorArray: { index: number; r: number; g: number; b: number; }[] = [];
-    for (let i = 0; i < colorArrayVal.length; i++) {
-      const c = colorArrayVal[i];
-      if (c) colorArray.push({ index: c.index, r: c.r, g: c.g, b: c.b }); else colorArray.push({ index: -1, r: 0, g:0, b:0 });
-    }
+    // CSR adjacency & color indices, copied out of WASM memory
+    const adjacency = readAdjacency(wasmModule, graph);
+    const coloring = readColoring(wasmModule, true);
     deletePreviousAlgorithmState();
     const newState: AlgorithmState = {
       graph: graph!,
@@ -130,12 +238,13 @@ function App() {
       palette: stateNode.palette!,
       coloringMap: stateNode.coloring!,
       adjacency,
-      colorArray,
+      coloring,
     };
     setAlgorithmState(newState);
     setInitialSnapshot(newState); // keep immutable reference for reset
     setFinished(false);
     setShowResultModal(false);
+    setColorReduction(null);
     setAlgorithmReady(true);
   }
 
@@ -150,84 +259,106 @@ function App() {
       return;
     }
     try {
-      wasmModule.algorithmStep();
-      const stateNode: StateNode | null = wasmModule.getCurrentAlgorithmState();
-      console.log("Stepped algorithm, new state:", stateNode);
-      if (stateNode) {
-        const graph = stateNode.graph!;
-        const adjacencyVal = wasmModule.getGraphAdjacency(graph);
-        const adjacency: number[][] = [];
-        for (let i = 0; i < adjacencyVal.length; i++) {
-          const row = adjacencyVal[i];
-          const inner: number[] = [];
-          for (let j = 0; j < row.length; j++) inner.push(row[j]);
-          adjacency.push(inner);
-        }
-        const colorArrayVal = wasmModule.getCurrentColorArray();
-        const colorArray: { index: number; r: number; g: number; b: number; }[] = [];
-        for (let i = 0; i < colorArrayVal.length; i++) {
-          const c = colorArrayVal[i];
-          if (c) colorArray.push({ index: c.index, r: c.r, g: c.g, b: c.b }); else colorArray.push({ index: -1, r: 0, g:0, b:0 });
-        }
-        const updated: AlgorithmState = {
-          graph,
-          conflicts: stateNode.conflicts,
-          coloringMap: stateNode.coloring!,
-          lastUsedColor: stateNode.color?.index ?? -1,
-          palette: stateNode.palette!,
-          adjacency,
-          colorArray,
-        };
-        setAlgorithmState(updated);
-        // Update current iteration/step from wasm
-        try {
-          // @ts-ignore
-          const iter = (wasmModule as any).getCurrentIteration?.() ?? currentStep + 1;
-          setCurrentStep(iter);
-        } catch {}
-        if (stateNode.conflicts === 0 || !stateNode.continueIteration) {
-          setFinished(true);
-          setShowResultModal(true);
-        }
+      // Only the recolored vertices come back; the full StateNode is not copied out per step
+      const delta = wasmModule.algorithmStepN(1) as StepDelta;
+      const coloring = { ...readColoring(wasmModule), changes: delta.changes };
+      setAlgorithmState(prev => prev ? ({
+        ...prev,
+        conflicts: delta.conflicts,
+        lastUsedColor: delta.color >= 0 ? delta.color : prev.lastUsedColor,
+        coloring,
+      }) : prev);
+      setCurrentStep(wasmModule.getCurrentIteration());
+      if (delta.conflicts === 0 || !delta.continueIteration) {
+        setFinished(true);
+        setShowResultModal(true);
       }
-      // Optionally could mark finished when cont is false
     } catch (e) {
       console.error(e);
     }
   }
 
+  // Run the search on a solver thread and follow it once per animation frame. Needs a module built
+  // with GRAPH_COLORING_WASM_THREADS on a cross-origin isolated page; returns false otherwise.
+  const startBackgroundRun = (): boolean => {
+    if (!wasmModule || !window.crossOriginIsolated) return false;
+    // The run owns the iterator from here on; readColoring's copies are what the viewer follows
+    const { indices: localIndices, palette: localPalette } = readColoring(wasmModule);
+    try {
+      wasmModule.startBackgroundRun(1024);
+    } catch {
+      return false;
+    }
+    const channel = wasmModule.getProgressChannel() as Int32Array;
+    setBackgroundRun({ paused: false });
+    const poll = () => {
+      // Status first: everything published before the run ended is then already in the ring
+      const status = Atomics.load(channel, Progress.Status);
+      const changes = drainProgress(channel, localIndices);
+      const conflicts = Atomics.load(channel, Progress.Conflicts);
+      setAlgorithmState(prev => prev ? ({
+        ...prev,
+        conflicts,
+        coloring: { indices: localIndices, palette: localPalette, changes },
+      }) : prev);
+      setCurrentStep(Atomics.load(channel, Progress.Iteration));
+      if (status >= SolverStatus.Finished) {
+        finishBackgroundRun();
+        return;
+      }
+      setBackgroundRun({ paused: status === SolverStatus.Paused });
+      backgroundFrame.current = requestAnimationFrame(poll);
+    };
+    backgroundFrame.current = requestAnimationFrame(poll);
+    return true;
+  };
+
+  const finishBackgroundRun = () => {
+    if (!wasmModule) return;
+    cancelAnimationFrame(backgroundFrame.current);
+    setBackgroundRun(null);
+    try {
+      wasmModule.finishBackgroundRun();
+    } catch (e) {
+      console.error(e);
+      return;
+    }
+    showFinalState();
+  };
+
+  const toggleBackgroundPause = () => {
+    if (!wasmModule || !backgroundRun) return;
+    // The flags are only read between batches; the status the next poll sees confirms the switch
+    if (backgroundRun.paused) wasmModule.resumeBackgroundRun();
+    else wasmModule.pauseBackgroundRun();
+  };
+
   const runAlgorithmToEnd = () => {
     if (!wasmModule) return;
     if (!algorithmState) return;
+    if (startBackgroundRun()) return;
     try {
       wasmModule.algorithmRunToEnd();
+      showFinalState();
+    } catch (e) {
+      console.error(e);
+    }
+  }
+
+  const showFinalState = () => {
+    if (!wasmModule) return;
+    try {
       const stateNode: StateNode | null = wasmModule.getCurrentAlgorithmState();
       if (stateNode) {
-        const graph = stateNode.graph!;
-        const adjacencyVal = wasmModule.getGraphAdjacency(graph);
-        const adjacency: number[][] = [];
-        for (let i = 0; i < adjacencyVal.length; i++) {
-          const row = adjacencyVal[i];
-          const inner: number[] = [];
-          for (let j = 0; j < row.length; j++) inner.push(row[j]);
-          adjacency.push(inner);
-        }
-        const colorArrayVal = wasmModule.getCurrentColorArray();
-        const colorArray: { index: number; r: number; g: number; b: number; }[] = [];
-        for (let i = 0; i < colorArrayVal.length; i++) {
-          const c = colorArrayVal[i];
-          if (c) colorArray.push({ index: c.index, r: c.r, g: c.g, b: c.b }); else colorArray.push({ index: -1, r: 0, g:0, b:0 });
-        }
-        const updated: AlgorithmState = {
-          graph,
+        const coloring = readColoring(wasmModule);
+        setAlgorithmState(prev => prev ? ({
+          ...prev,
           conflicts: stateNode.conflicts,
-          lastUsedColor: stateNode.color?.index ?? -1,
+          lastUsedColor: stateNode.color,
           palette: stateNode.palette!,
           coloringMap: stateNode.coloring!,
-          adjacency,
-          colorArray,
-        };
-        setAlgorithmState(updated);
+          coloring,
+        }) : prev);
         try {
           // @ts-ignore
           const iter = (wasmModule as any).getCurrentIteration?.() ?? currentStep;
@@ -251,16 +382,14 @@ function App() {
     } catch (e) {
       console.warn('Failed to reset algorithm on wasm side', e);
     }
-    // Restore snapshot (deep copy of arrays to avoid accidental mutation)
-    const restoreAdjacency = initialSnapshot.adjacency.map(r => [...r]);
-    const restoreColors = initialSnapshot.colorArray.map(c => ({...c}));
+    // Restore snapshot; the preserved initial coloring still lives in WASM, so re-read its view
     setAlgorithmState({
       ...initialSnapshot,
-      adjacency: restoreAdjacency,
-      colorArray: restoreColors,
+      coloring: readColoring(wasmModule, true),
     });
     setFinished(false);
     setShowResultModal(false);
+    setColorReduction(null);
     // Reinitialize algorithm iterator so step / run can work again immediately
     try {
       // @ts-ignore
@@ -280,19 +409,13 @@ function App() {
       (wasmModule as any).runGreedyRemoveConflicts();
       const stateNode: StateNode | null = wasmModule.getCurrentAlgorithmState();
       if (stateNode) {
-        // rebuild color array
-        const colorArrayVal = wasmModule.getCurrentColorArray();
-        const colorArray: { index: number; r: number; g: number; b: number; }[] = [];
-        for (let i = 0; i < colorArrayVal.length; i++) {
-          const c = colorArrayVal[i];
-          if (c) colorArray.push({ index: c.index, r: c.r, g: c.g, b: c.b }); else colorArray.push({ index: -1, r:0,g:0,b:0});
-        }
+        const coloring = readColoring(wasmModule);
         setAlgorithmState(prev => prev ? ({
           ...prev,
           conflicts: stateNode.conflicts,
-          lastUsedColor: stateNode.color?.index ?? prev.lastUsedColor,
+          lastUsedColor: stateNode.color,
           coloringMap: stateNode.coloring!,
-          colorArray,
+          coloring,
         }) : prev);
         try {
           // @ts-ignore
@@ -308,6 +431,30 @@ function App() {
     }
   };
 
+  // Retire colors one at a time (tabu search per palette size, 10 s budget); the fewest-color
+  // valid coloring found becomes the active state
+  const runReduceColors = () => {
+    if (!wasmModule) return;
+    try {
+      const result = (wasmModule as any).runColorReduction('tabu', 100000, 10);
+      setColorReduction({ bestColors: result.bestColors, iterations: result.iterations, runs: result.runs });
+      const stateNode: StateNode | null = wasmModule.getCurrentAlgorithmState();
+      if (stateNode) {
+        const coloring = readColoring(wasmModule);
+        setAlgorithmState(prev => prev ? ({
+          ...prev,
+          conflicts: stateNode.conflicts,
+          lastUsedColor: stateNode.color,
+          coloringMap: stateNode.coloring!,
+          coloring,
+        }) : prev);
+        setCurrentStep(0);
+      }
+    } catch (e) {
+      console.error(e);
+    }
+  };
+
   return (
     <>
       <div className="h-screen bg-white overflow-hidden lg:overflow-hidden overflow-y-auto">
@@ -329,10 +476,11 @@ function App() {
                   <div className="rounded bg-gray-200 px-2 py-1 text-xs flex items-center gap-1">
                     { (algorithmState && algorithmState.lastUsedColor >= 0) ? (
                       (() => {
-                        const colorObj = algorithmState.colorArray.find(c => c.index === algorithmState.lastUsedColor);
-                        if (!colorObj) return <span>None</span>;
-                        const style: React.CSSProperties = { width: 18, height: 12, backgroundColor: `rgb(${colorObj.r},${colorObj.g},${colorObj.b})`, border: '1px solid #888', borderRadius: 2 };
-                        return <div style={style} title={`Color #${colorObj.index}`}></div>;
+                        const { palette } = algorithmState.coloring;
+                        const c = algorithmState.lastUsedColor;
+                        if (3 * c + 2 >= palette.length) return <span>None</span>;
+                        const style: React.CSSProperties = { width: 18, height: 12, backgroundColor: `rgb(${palette[3 * c]},${palette[3 * c + 1]},${palette[3 * c + 2]})`, border: '1px solid #888', borderRadius: 2 };
+                        return <div style={style} title={`Color #${c}`}></div>;
                       })()
                     ) : 'None' }
                   </div>
@@ -346,7 +494,7 @@ function App() {
               <Card className="mb-2 flex-1 lg:flex-1 bg-gray-200 flex">
                 <CardContent className="flex h-[60vh] w-full p-0 flex-1">
                   {algorithmState?.graph ? (
-                    <AdjacencyGraphViewer adjacency={algorithmState.adjacency} colors={algorithmState.colorArray} />
+                    <AdjacencyGraphViewer adjacency={algorithmState.adjacency} coloring={algorithmState.coloring} />
                   ) : (
                     <div className="m-auto text-gray-500 text-sm select-none">Generate a graph to visualize</div>
                   )}
@@ -358,10 +506,20 @@ function App() {
                 <Button size="sm" variant="outline" disabled={finished || !algorithmReady} className="h-8 w-8 p-0" onClick={stepAlgorithm}>
                   <Play className="h-3 w-3"  />
                 </Button>
-                <Button size="sm" variant="outline" disabled={finished || !algorithmReady} className="h-8 w-8 p-0" onClick={runAlgorithmToEnd}>
+                <Button size="sm" variant="outline" disabled={finished || !algorithmReady || !!backgroundRun} className="h-8 w-8 p-0" onClick={runAlgorithmToEnd}>
                   <FastForward className="h-3 w-3"  />
                 </Button>
-                <Button size="sm" variant="outline" className="h-8 px-3" onClick={resetToInitial} disabled={!initialSnapshot}>
+                {backgroundRun && (
+                  <>
+                    <Button size="sm" variant="outline" className="h-8 w-8 p-0" onClick={toggleBackgroundPause}>
+                      {backgroundRun.paused ? <Play className="h-3 w-3" /> : <Pause className="h-3 w-3" />}
+                    </Button>
+                    <Button size="sm" variant="outline" className="h-8 w-8 p-0" onClick={() => wasmModule?.cancelBackgroundRun()}>
+                      <Square className="h-3 w-3" />
+                    </Button>
+                  </>
+                )}
+                <Button size="sm" variant="outline" className="h-8 px-3" onClick={resetToInitial} disabled={!initialSnapshot || !!backgroundRun}>
                   Reset
                 </Button>
               </div>
@@ -415,11 +573,117 @@ function App() {
                           <SelectContent>
                             <SelectItem value="hill_climbing">Hill Climbing</SelectItem>
                             <SelectItem value="simulated_annealing">Simulated Annealing</SelectItem>
+                            <SelectItem value="parallel_tempering">Parallel Tempering</SelectItem>
+                            <SelectItem value="tabu">Tabu Search</SelectItem>
                             <SelectItem value="beam">Beam Search</SelectItem>
                           </SelectContent>
                         </Select>
                     </div>
 
+                    {(algorithmName === 'hill_climbing' || algorithmName === 'simulated_annealing') && (
+                      <div>
+                        <Label htmlFor="neighborhood" className="text-xs">
+                          Moves
+                        </Label>
+                        <Select value={kempeChains ? 'kempe' : 'recolor'} onValueChange={(v) => setKempeChains(v === 'kempe')}>
+                          <SelectTrigger className="mt-1 h-8 text-xs">
+                            <SelectValue placeholder="Select moves" />
+                          </SelectTrigger>
+                          <SelectContent>
+                            <SelectItem value="recolor">Recolor a vertex</SelectItem>
+                            <SelectItem value="kempe">Recolor + Kempe chains</SelectItem>
+                          </SelectContent>
+                        </Select>
+                      </div>
+                    )}
+
+                    {algorithmName === 'simulated_annealing' && (
+                      <div>
+                        <Label htmlFor="schedule" className="text-xs">
+                          Cooling schedule
+                        </Label>
+                        <Select value={annealingSchedule} onValueChange={setAnnealingSchedule}>
+                          <SelectTrigger className="mt-1 h-8 text-xs">
+                            <SelectValue placeholder="Select schedule" />
+                          </SelectTrigger>
+                          <SelectContent>
+                            <SelectItem value="geometric">Geometric</SelectItem>
+                            <SelectItem value="linear">Linear</SelectItem>
+                            <SelectItem value="logarithmic">Logarithmic</SelectItem>
+                            <SelectItem value="adaptive">Adaptive</SelectItem>
+                          </SelectContent>
+                        </Select>
+                      </div>
+                    )}
+
+                    <div>
+                      <Label htmlFor="initial-coloring" className="text-xs">
+                        Initial coloring
+                      </Label>
+                      <Select value={initialColoring} onValueChange={setInitialColoring}>
+                        <SelectTrigger className="mt-1 h-8 text-xs">
+                          <SelectValue placeholder="Select initial coloring" />
+                        </SelectTrigger>
+                        <SelectContent>
+                          <SelectItem value="random">Random</SelectItem>
+                          <SelectItem value="greedy">Greedy (by degree)</SelectItem>
+                          <SelectItem value="dsatur">DSatur</SelectItem>
+                          <SelectItem value="rlf">RLF</SelectItem>
+                        </SelectContent>
+                      </Select>
+                    </div>
+
+                    {initialColoring !== 'random' && (
+                      <div>
+                        <Label htmlFor="start-colors" className="text-xs">
+                          Search colors
+                        </Label>
+                        <Select value={oneColorFewer ? 'fewer' : 'same'} onValueChange={(v) => setOneColorFewer(v === 'fewer')}>
+                          <SelectTrigger className="mt-1 h-8 text-xs">
+                            <SelectValue placeholder="Select color count" />
+                          </SelectTrigger>
+                          <SelectContent>
+                            <SelectItem value="same">Colors it used</SelectItem>
+                            <SelectItem value="fewer">One color fewer</SelectItem>
+                          </SelectContent>
+                        </Select>
+                      </div>
+                    )}
+
+                    {initialColoring !== 'random' && (
+                      <div>
+                        <Label htmlFor="peel" className="text-xs">
+                          Low-degree vertices
+                        </Label>
+                        <Select value={peel ? 'peel' : 'search'} onValueChange={(v) => setPeel(v === 'peel')}>
+                          <SelectTrigger className="mt-1 h-8 text-xs">
+                            <SelectValue placeholder="Select handling" />
+                          </SelectTrigger>
+                          <SelectContent>
+                            <SelectItem value="search">Search them</SelectItem>
+                            <SelectItem value="peel">Color them afterwards</SelectItem>
+                          </SelectContent>
+                        </Select>
+                      </div>
+                    )}
+
+                    <div>
+                      <Label htmlFor="vertex-order" className="text-xs">
+                        Vertex order
+                      </Label>
+                      <Select value={vertexOrder} onValueChange={setVertexOrder}>
+                        <SelectTrigger className="mt-1 h-8 text-xs">
+                          <SelectValue placeholder="Select vertex order" />
+                        </SelectTrigger>
+                        <SelectContent>
+                          <SelectItem value="original">As generated</SelectItem>
+                          <SelectItem value="degree">By degree</SelectItem>
+                          <SelectItem value="rcm">Reverse Cuthill-McKee</SelectItem>
+                          <SelectItem value="bfs">Breadth-first</SelectItem>
+                        </SelectContent>
+                      </Select>
+                    </div>
+
                     <div>
                       <Label htmlFor="iterations" className="text-xs">
                         Iterations
@@ -439,6 +703,19 @@ function App() {
                     <Button className="w-full bg-red-300 text-black hover:bg-red-400" onClick={generateInitialState}>
                       Generate initial state
                     </Button>
+                    <Label htmlFor="graph-file" className="text-xs mt-2 block">
+                      Or load a DIMACS .col / edge list
+                    </Label>
+                    <Input
+                      id="graph-file"
+                      type="file"
+                      accept=".col,.txt,.edges"
+                      className="mt-1 h-8 text-xs"
+                      onChange={(e) => {
+                        const file = e.target.files?.[0]
+                        if (file) loadGraphFromFile(file)
+                      }}
+                    />
                   </div>
                 </CardContent>
               </Card>
@@ -447,7 +724,7 @@ function App() {
         </div>
       </div>
       {/* Result Modal */}
-      <ResultModal open={showResultModal} onClose={() => setShowResultModal(false)} conflicts={algorithmState?.conflicts ?? 0} iterations={iterations} onGreedyRemove={runGreedyRemove} />
+      <ResultModal open={showResultModal} onClose={() => setShowResultModal(false)} conflicts={algorithmState?.conflicts ?? 0} iterations={iterations} reduction={colorReduction} onGreedyRemove={runGreedyRemove} onReduceColors={runReduceColors} />
     </>
   )
 }
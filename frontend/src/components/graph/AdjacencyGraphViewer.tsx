@@ -4,52 +4,87 @@ import Graphology from 'graphology';
 import { SigmaContainer, useLoadGraph, useSigma, useRegisterEvents, useSetSettings, useCamera } from '@react-sigma/core';
 import '@react-sigma/core/lib/style.css';
 
+// CSR adjacency: neighbors of vertex i are targets[offsets[i] .. offsets[i + 1])
+export interface CsrAdjacency {
+  offsets: Uint32Array;
+  targets: Uint32Array;
+}
+
+// Color index per vertex plus the palette as packed RGB bytes (color c at [3c, 3c + 3))
+export interface IndexedColoring {
+  indices: Int32Array;
+  palette: Uint8Array;
+  // (vertex, oldColor, newColor, conflictsAfter) records; when present only these vertices are recolored
+  changes?: Int32Array;
+}
+
 export interface AdjacencyGraphViewerProps {
-  adjacency: number[][]; // array of neighbor index arrays
-  colors?: { index: number; r: number; g: number; b: number; }[] | (undefined | { index: number; r: number; g: number; b: number; })[];
+  adjacency: CsrAdjacency;
+  coloring?: IndexedColoring;
   className?: string;
   disableHoverEffect?: boolean;
 }
 
-function buildGraph(adjacency: number[][], colors?: (undefined | { index: number; r: number; g: number; b: number; })[]) {
+const toHex = (v: number) => v.toString(16).padStart(2, '0');
+
+function colorOf(coloring: IndexedColoring, i: number): string | undefined {
+  const c = coloring.indices[i];
+  if (c === undefined || c < 0) return undefined;
+  const { palette } = coloring;
+  return `#${toHex(palette[3 * c])}${toHex(palette[3 * c + 1])}${toHex(palette[3 * c + 2])}`;
+}
+
+// The typed arrays may be views into WASM memory, so they are read here and never retained
+function buildGraph({ offsets, targets }: CsrAdjacency) {
   const g = new Graphology();
-  const n = adjacency.length;
+  const n = Math.max(0, offsets.length - 1);
   const radius = Math.max(50, n * 2);
   for (let i = 0; i < n; i++) {
     const angle = (i / Math.max(1, n)) * Math.PI * 2;
     const x = Math.cos(angle) * radius;
     const y = Math.sin(angle) * radius;
-    let color: string | undefined;
-    const c = colors?.[i];
-    if (c) {
-      const toHex = (v: number) => v.toString(16).padStart(2, '0');
-      color = `#${toHex(c.r)}${toHex(c.g)}${toHex(c.b)}`;
-    }
-    g.addNode(`n${i}`, { x, y, size: 5, label: `n${i}`, color });
+    g.addNode(`n${i}`, { x, y, size: 5, label: `n${i}`, index: i });
   }
-  const seen = new Set<string>();
   for (let i = 0; i < n; i++) {
-    for (const j of adjacency[i]) {
-      if (j === i) continue;
-      const a = Math.min(i, j);
-      const b = Math.max(i, j);
-      const key = `${a}-${b}`;
-      if (!seen.has(key)) {
-        seen.add(key);
-        try { g.addEdge(`n${a}`, `n${b}`, { size: 2, color: '#000' }); } catch { /* ignore */ }
+    for (let e = offsets[i]; e < offsets[i + 1]; e++) {
+      const j = targets[e];
+      // each undirected edge is stored from both endpoints; add it once from the lower one
+      if (j <= i) continue;
+      const key = `${i}-${j}`;
+      if (!g.hasEdge(key)) {
+        try { g.addEdgeWithKey(key, `n${i}`, `n${j}`, { size: 2, color: '#000' }); } catch { /* ignore */ }
       }
     }
   }
   return g;
 }
 
-const Loader: FC<AdjacencyGraphViewerProps> = ({ adjacency, colors }) => {
+const Loader: FC<{ adjacency: CsrAdjacency }> = ({ adjacency }) => {
   const loadGraph = useLoadGraph();
-  const instance = useMemo(() => buildGraph(adjacency, colors as any), [adjacency, colors]);
+  const instance = useMemo(() => buildGraph(adjacency), [adjacency]);
   useEffect(() => { loadGraph(instance); }, [instance, loadGraph]);
   return null;
 };
 
+// Recolor nodes in place; the graph itself is only rebuilt when the adjacency changes
+const ColorSync: FC<{ adjacency: CsrAdjacency, coloring?: IndexedColoring }> = ({ adjacency, coloring }) => {
+  const sigma = useSigma();
+  useEffect(() => {
+    if (!coloring) return;
+    const graph = sigma.getGraph();
+    const { changes } = coloring;
+    if (changes) {
+      for (let i = 0; i < changes.length; i += 4) {
+        const v = changes[i];
+        graph.setNodeAttribute(`n${v}`, 'color', colorOf(coloring, v));
+      }
+      return;
+    }
+    graph.updateEachNodeAttributes((_node, attr) => ({ ...attr, color: colorOf(coloring, attr.index as number) }));
+  }, [adjacency, coloring, sigma]);
+  return null;
+};
+
 const HoverEffects: FC<{ disableHoverEffect?: boolean }> = ({ disableHoverEffect }) => {
   const sigma = useSigma();
   const registerEvents = useRegisterEvents();
@@ -124,12 +159,13 @@ export const FocusOnNode: FC<{ node: string | null; move?: boolean }> = ({ node,
 };
 
 
-export const AdjacencyGraphViewer: FC<AdjacencyGraphViewerProps> = ({ adjacency, colors, className, disableHoverEffect }) => {
+export const AdjacencyGraphViewer: FC<AdjacencyGraphViewerProps> = ({ adjacency, coloring, className, disableHoverEffect }) => {
   const [selectedNode] = useState<string | null>(null);
 
   return (
   <SigmaContainer style={{ width: '100%', height: '100%', minHeight: '400px' }} className={className} settings={{ enableEdgeEvents: true }}>
-    <Loader adjacency={adjacency} colors={colors} />
+    <Loader adjacency={adjacency} />
+    <ColorSync adjacency={adjacency} coloring={coloring} />
     <HoverEffects disableHoverEffect={disableHoverEffect} />
     <FocusOnNode node={selectedNode} />
   </SigmaContainer>
@@ -12,6 +12,12 @@ export default defineConfig({
     },
   },
   server: {
+    // Cross-origin isolation makes SharedArrayBuffer available, which a pthreads build of the
+    // module (background runs) needs
+    headers: {
+      'Cross-Origin-Opener-Policy': 'same-origin',
+      'Cross-Origin-Embedder-Policy': 'require-corp',
+    },
     fs: {
       allow: [searchForWorkspaceRoot(process.cwd()), '../build/GraphColoring.wasm']
     }
@@ -3,8 +3,11 @@
 #include <vector>
 #include <random>
 #include <climits>
+#include <cmath>
 #include <memory>
+#include <optional>
 #include <algorithm>
+#include <stdexcept>
 
 // Deterministic extra color generator (in case preset palette is insufficient)
 static Color generateExtraColor(int order)
@@ -23,144 +26,516 @@ static Color generateExtraColor(int order)
             channel(151, 197)};
 }
 
-static int countNodeConflicts(std::shared_ptr<GraphNode> node, const ColoringMap &coloring)
+static int countNodeConflicts(const Graph &graph, VertexId node, const ColoringArray &coloring)
 {
-    int conflictCount = 0;
-    auto itNode = coloring.find(node);
-    if (itNode == coloring.end())
-    {
-        throw std::runtime_error("Node not found in coloring map");
-    }
-    int nodeColor = itNode->second.index;
-    for (const auto &neighbor : node->getNeighbors())
-    {
-        auto itNeighbor = coloring.find(neighbor);
-        if (itNeighbor == coloring.end())
-            continue;
-        if (nodeColor == itNeighbor->second.index)
-            ++conflictCount;
-    }
-    return conflictCount;
+    return countNeighborsWithColor(graph.neighbors(node), coloring.data(), coloring[node]);
 }
 
-void greedyRemoveConflicts(StateNode &state)
+RepairResult repairConflicts(StateNode &state, int budget)
 {
-    for (auto node : state.graph->getNodes())
+    const Graph &graph = *state.graph;
+    const int numColors = state.palette.size();
+    RepairResult result;
+    std::vector<VertexId> worklist;
+    std::vector<std::uint8_t> queued(graph.numVertices(), 0);
+    auto enqueue = [&](VertexId v)
     {
-        int conflicts = countNodeConflicts(node, state.coloring);
-        if (conflicts > 0)
+        if (state.nodeConflicts[v] > 0 && !queued[v])
         {
-            for (int colorIdx = 0; colorIdx < state.palette.size(); ++colorIdx)
-            {
-                if (colorIdx == state.coloring[node].index)
-                    continue; // skip current color
+            queued[v] = 1;
+            worklist.push_back(v);
+        }
+    };
+    for (VertexId v = 0; v < graph.numVertices(); ++v)
+        enqueue(v);
 
-                // Temporarily assign new color and count conflicts
-                state.coloring[node] = state.palette.getColor(colorIdx);
-                int newConflicts = countNodeConflicts(node, state.coloring);
+    // Neighbors per color of the vertex being repaired; taken from the neighbor color table
+    // when the state keeps one, otherwise counted here and cleared again after each vertex
+    std::vector<int> histogram(state.neighborColors.empty() ? numColors : 0, 0);
+    std::size_t head = 0;
+    while (head < worklist.size())
+    {
+        if (budget >= 0 && result.recolorings >= budget)
+        {
+            result.fixpoint = false;
+            break;
+        }
+        VertexId v = worklist[head++];
+        queued[v] = 0;
+        if (state.nodeConflicts[v] == 0)
+            continue;
 
-                if (newConflicts == 0)
-                {
-                    break;
-                }
-            }
+        const int *counts = histogram.data();
+        if (state.neighborColors.empty())
+            addNeighborColors(graph.neighbors(v), state.coloring.data(), v, histogram.data());
+        else
+            counts = state.neighborColorRow(v);
+        int best = state.coloring[v];
+        for (int c = 0; c < numColors && counts[best] > 0; ++c)
+        {
+            if (counts[c] < counts[best])
+                best = c;
+        }
+        if (state.neighborColors.empty())
+        {
+            for (VertexId nbr : graph.neighbors(v))
+                histogram[state.coloring[nbr]] = 0;
+        }
+        if (best == state.coloring[v])
+            continue;
+
+        // Every move strictly lowers the conflict total, so the loop terminates. Neighbors on
+        // the new color now conflict with v, and conflicting neighbors on the old one may
+        // have gained a better color: both go back on the worklist.
+        state.forward(best, v);
+        ++result.recolorings;
+        for (VertexId nbr : graph.neighbors(v))
+            enqueue(nbr);
+
+        // Compact the consumed prefix once it dominates the worklist
+        if (head > 4096 && head * 2 > worklist.size())
+        {
+            worklist.erase(worklist.begin(), worklist.begin() + static_cast<std::ptrdiff_t>(head));
+            head = 0;
         }
     }
+    return result;
+}
+
+// repairConflicts() on an iterator's reported state, appending the recolors it made to log
+static RepairResult repairLogged(StateNode &state, std::vector<VertexChange> *log)
+{
+    if (!log)
+        return repairConflicts(state);
+    ColoringArray before = state.coloring;
+    RepairResult result = repairConflicts(state);
+    for (VertexId v = 0; v < before.size(); ++v)
+    {
+        if (before[v] != state.coloring[v])
+            log->push_back(VertexChange{v, before[v], state.coloring[v], state.conflicts});
+    }
+    return result;
 }
 
 // Evaluate number of conflicting edges (endpoints share the same color)
-int computeConflicts(const Graph &graph, const ColoringMap &coloring)
+int computeConflicts(const Graph &graph, const ColoringArray &coloring)
 {
     long long conflictCount = 0;
-    for (const auto &node : graph.getNodes())
+    for (VertexId node = 0; node < graph.numVertices(); ++node)
     {
-        conflictCount += countNodeConflicts(node, coloring);
+        conflictCount += countNodeConflicts(graph, node, coloring);
     }
     return static_cast<int>(conflictCount / 2);
 }
 
-std::shared_ptr<GraphNode> selectNextNode(const StateNode &state)
+StateNode stateFromColoring(std::shared_ptr<Graph> graph, const ColorPalette &palette, ColoringArray coloring)
 {
-    std::shared_ptr<GraphNode> bestV = nullptr;
-    int bestIncident = -1;
-    int bestColorUse = INT_MAX; // we prefer the least-used color
-    for (auto v : state.graph->getNodes())
-    {
-        auto itv = state.coloring.find(v);
-        if (itv == state.coloring.end())
-            continue;
-        int vcol = itv->second.index;
+    UsedColorsArray usedColors(palette.size(), 0);
+    for (int c : coloring)
+        usedColors[c]++;
+    int conflicts = computeConflicts(*graph, coloring);
+    return StateNode{std::move(graph), palette, std::move(coloring), conflicts, std::move(usedColors)};
+}
 
-        // how many neighbors share v's color
-        int incident = 0;
-        for (auto nbr : v->getNeighbors())
+void ConflictBuckets::reset(std::size_t numVertices, int maxConflicts, int numColors)
+{
+    numColors_ = numColors;
+    topLevel_ = 0;
+    heads_.assign(static_cast<std::size_t>(maxConflicts + 1) * numColors, -1);
+    levelSize_.assign(maxConflicts + 1, 0);
+    next_.assign(numVertices, -1);
+    prev_.assign(numVertices, -1);
+    slot_.assign(numVertices, -1);
+}
+
+void ConflictBuckets::dropLastColor()
+{
+    const int colors = numColors_ - 1;
+    // Rows only move towards the front, so compacting in place never overwrites an unread head
+    for (std::size_t level = 0; level < levelSize_.size(); ++level)
+    {
+        for (int c = 0; c < colors; ++c)
         {
-            auto itn = state.coloring.find(nbr);
-            if (itn != state.coloring.end() && itn->second.index == vcol)
-                ++incident;
+            int slot = static_cast<int>(level) * colors + c;
+            heads_[slot] = heads_[level * numColors_ + c];
+            for (int v = heads_[slot]; v >= 0; v = next_[v])
+                slot_[v] = slot;
         }
+    }
+    heads_.resize(levelSize_.size() * colors);
+    numColors_ = colors;
+}
 
-        // skip vertices that are currently conflict-free
-        if (incident == 0)
-            continue;
+void ConflictBuckets::unlink(VertexId v)
+{
+    int slot = slot_[v];
+    if (slot < 0)
+        return;
+    if (prev_[v] >= 0)
+        next_[prev_[v]] = next_[v];
+    else
+        heads_[slot] = next_[v];
+    if (next_[v] >= 0)
+        prev_[next_[v]] = prev_[v];
+    slot_[v] = -1;
+    --levelSize_[slot / numColors_];
+    // The top level only drops here, so this walk is amortized against the insertions that raised it
+    while (topLevel_ > 0 && levelSize_[topLevel_] == 0)
+        --topLevel_;
+}
 
-        int colorUse = 0;
-        if (auto itUse = state.usedColors.find(vcol); itUse != state.usedColors.end())
-            colorUse = itUse->second;
+void ConflictBuckets::set(VertexId v, int conflicts, int color)
+{
+    int slot = conflicts > 0 ? conflicts * numColors_ + color : -1;
+    if (slot == slot_[v])
+        return;
+    unlink(v);
+    if (slot < 0)
+        return;
+    int head = heads_[slot];
+    next_[v] = head;
+    prev_[v] = -1;
+    if (head >= 0)
+        prev_[head] = static_cast<int>(v);
+    heads_[slot] = static_cast<int>(v);
+    slot_[v] = slot;
+    ++levelSize_[conflicts];
+    topLevel_ = std::max(topLevel_, conflicts);
+}
+
+void ConflictBuckets::save(CheckpointWriter &out) const
+{
+    // Each chain is written tail first, so re-inserting at the head in file order rebuilds it
+    std::vector<VertexId> order;
+    std::vector<VertexId> chain;
+    for (int head : heads_)
+    {
+        chain.clear();
+        for (int v = head; v >= 0; v = next_[v])
+            chain.push_back(static_cast<VertexId>(v));
+        order.insert(order.end(), chain.rbegin(), chain.rend());
+    }
+    out.writeArray(order);
+}
 
-        // choose the vertex whose conflicts are the most; tie-breaker: least used color
-        if (incident > bestIncident || (incident == bestIncident && colorUse < bestColorUse))
+void ConflictBuckets::restore(CheckpointReader &in)
+{
+    auto order = in.readArray<VertexId>();
+    std::size_t queued = 0;
+    for (int size : levelSize_)
+        queued += static_cast<std::size_t>(size);
+    if (order.size() != queued)
+        throw std::runtime_error("Checkpoint conflict queue does not match its coloring");
+    for (VertexId v : order)
+    {
+        if (v >= slot_.size() || slot_[v] < 0)
+            throw std::runtime_error("Checkpoint conflict queue does not match its coloring");
+        int slot = slot_[v];
+        unlink(v);
+        set(v, slot / numColors_, slot % numColors_);
+    }
+}
+
+void StateNode::rebuildConflictIndex()
+{
+    const Graph &g = *graph;
+    nodeConflicts.assign(g.numVertices(), 0);
+    conflictQueue.reset(g.numVertices(), static_cast<int>(g.maxDegree()), palette.size());
+    long long total = 0;
+    for (VertexId v = 0; v < g.numVertices(); ++v)
+    {
+        int incident = countNeighborsWithColor(g.neighbors(v), coloring.data(), coloring[v], v);
+        nodeConflicts[v] = incident;
+        conflictQueue.set(v, incident, coloring[v]);
+        total += incident;
+    }
+    // Self-loops conflict under every color and stay out of the per-vertex counters
+    conflicts = static_cast<int>(total / 2 + static_cast<long long>(g.numSelfLoops()));
+    if (!neighborColors.empty())
+        enableNeighborColorTable();
+}
+
+void StateNode::enableNeighborColorTable()
+{
+    const Graph &g = *graph;
+    const std::size_t stride = palette.size();
+    neighborColors.assign(g.numVertices() * stride, 0);
+    for (VertexId v = 0; v < g.numVertices(); ++v)
+    {
+        addNeighborColors(g.neighbors(v), coloring.data(), v, neighborColors.data() + v * stride);
+    }
+}
+
+void KempeChain::reserve(std::size_t numVertices)
+{
+    stamp_.assign(numVertices, 0);
+    epoch_ = 0;
+    // A chain never holds a vertex twice
+    chain_.reserve(numVertices);
+}
+
+KempeMove KempeChain::evaluate(const StateNode &state, VertexId v, int b)
+{
+    const Graph &graph = *state.graph;
+    const int *coloring = state.coloring.data();
+    fromColor_ = coloring[v];
+    toColor_ = b;
+    chain_.clear();
+    // The walk below assumes two distinct colors; a same-color swap would count every vertex twice
+    if (b == fromColor_)
+        return KempeMove{};
+    if (stamp_.size() != graph.numVertices())
+        reserve(graph.numVertices());
+    if (++epoch_ == 0)
+    {
+        std::fill(stamp_.begin(), stamp_.end(), 0);
+        epoch_ = 1;
+    }
+
+    chain_.push_back(v);
+    stamp_[v] = epoch_;
+    for (std::size_t head = 0; head < chain_.size(); ++head)
+    {
+        VertexId x = chain_[head];
+        int own = coloring[x];
+        visitNeighborsWithColors(graph.neighbors(x), coloring, fromColor_, toColor_, x, [&](VertexId nbr, int nbrColor)
+                                 {
+            if (nbrColor != own && stamp_[nbr] != epoch_)
+            {
+                stamp_[nbr] = epoch_;
+                chain_.push_back(nbr);
+            } });
+    }
+
+    // Only conflicts with one end outside the chain change: after the swap that end keeps the
+    // color the chain vertex leaves, and every neighbor on the color it takes is in the chain
+    KempeMove move;
+    for (VertexId x : chain_)
+    {
+        int own = coloring[x];
+        int inside = 0;
+        visitNeighborsWithColors(graph.neighbors(x), coloring, own, own, x, [&](VertexId nbr, int)
+                                 { inside += inChain(nbr); });
+        move.conflictDelta -= state.nodeConflicts[x] - inside;
+        if (own == fromColor_)
+            ++move.fromCount;
+        else
+            ++move.toCount;
+    }
+    return move;
+}
+
+void KempeChain::apply(StateNode &state, std::vector<VertexChange> *changeLog) const
+{
+    for (VertexId x : chain_)
+    {
+        int oldColor = state.coloring[x];
+        int newColor = oldColor == fromColor_ ? toColor_ : fromColor_;
+        state.forward(newColor, x);
+        if (changeLog)
+            changeLog->push_back(VertexChange{x, oldColor, newColor, state.conflicts});
+    }
+}
+
+void StateNode::removeColor(int color)
+{
+    if (palette.size() < 2)
+        throw std::logic_error("Cannot remove the only color");
+    const Graph &g = *graph;
+    const int last = palette.size() - 1;
+    std::vector<int> histogram(neighborColors.empty() ? palette.size() : 0, 0);
+    for (VertexId v = 0; v < g.numVertices(); ++v)
+    {
+        if (coloring[v] != color)
+            continue;
+        const int *counts = histogram.data();
+        if (neighborColors.empty())
+            addNeighborColors(g.neighbors(v), coloring.data(), v, histogram.data());
+        else
+            counts = neighborColorRow(v);
+        int best = color == 0 ? 1 : 0;
+        for (int c = 0; c <= last; ++c)
         {
-            bestColorUse = colorUse;
-            bestIncident = incident;
-            bestV = v;
+            if (c != color && counts[c] < counts[best])
+                best = c;
         }
+        if (neighborColors.empty())
+            std::fill(histogram.begin(), histogram.end(), 0);
+        forward(best, v);
+    }
+    if (color != last)
+    {
+        for (VertexId v = 0; v < g.numVertices(); ++v)
+        {
+            if (coloring[v] == last)
+                forward(color, v);
+        }
+    }
+
+    // Nothing uses the last color any more; drop its column everywhere
+    palette.removeLastColor();
+    usedColors.pop_back();
+    conflictQueue.dropLastColor();
+    if (!neighborColors.empty())
+    {
+        const std::size_t stride = static_cast<std::size_t>(last) + 1;
+        for (std::size_t v = 0; v < g.numVertices(); ++v)
+            std::copy_n(neighborColors.begin() + v * stride, last, neighborColors.begin() + v * last);
+        neighborColors.resize(g.numVertices() * last);
     }
-    return bestV;
+    // forward() left color on the last recolor, which may be the dropped index
+    if (this->color >= last)
+        this->color = -1;
 }
 
-HillClimbingColoringIterator::HillClimbingColoringIterator(std::unique_ptr<StateNode> initialState, int maxIterations, std::mt19937 rng)
-    : current_(std::move(*initialState)), maxIterations_(maxIterations), iteration_(0), finished_(false), rng_(std::move(rng)), greedyDone_(false)
+void ConflictingVertices::reset(const StateNode &state)
 {
+    const std::size_t n = state.coloring.size();
+    pos_.assign(n, -1);
+    list_.clear();
+    list_.reserve(n);
+    for (VertexId v = 0; v < n; ++v)
+        update(state, v);
 }
 
-StateNode HillClimbingColoringIterator::step()
+void ConflictingVertices::update(const StateNode &state, VertexId v)
 {
-    if (iteration_ >= maxIterations_)
+    bool conflicted = state.nodeConflicts[v] > 0;
+    int &pos = pos_[v];
+    if (conflicted && pos < 0)
+    {
+        pos = static_cast<int>(list_.size());
+        list_.push_back(v);
+    }
+    else if (!conflicted && pos >= 0)
+    {
+        VertexId last = list_.back();
+        list_[pos] = last;
+        pos_[last] = pos;
+        list_.pop_back();
+        pos = -1;
+    }
+}
+
+void ConflictingVertices::updateAround(const StateNode &state, VertexId v)
+{
+    update(state, v);
+    for (VertexId nbr : state.graph->neighbors(v))
+        update(state, nbr);
+}
+
+bool ConflictingVertices::restoreOrder(std::span<const VertexId> order)
+{
+    if (order.size() != list_.size())
+        return false;
+    for (VertexId v : order)
+    {
+        if (v >= pos_.size() || pos_[v] < 0)
+            return false;
+    }
+    list_.assign(order.begin(), order.end());
+    for (std::size_t i = 0; i < list_.size(); ++i)
+        pos_[list_[i]] = static_cast<int>(i);
+    return true;
+}
+
+// Choose the vertex whose conflicts are the most; tie-breaker: least used color
+int selectNextNode(const StateNode &state)
+{
+    return state.conflictQueue.select(state.usedColors);
+}
+
+HillClimbingColoringIterator::HillClimbingColoringIterator(std::unique_ptr<StateNode> initialState, int maxIterations, std::mt19937 rng, const NeighborhoodOptions &neighborhood)
+    : current_(std::move(*initialState)), maxIterations_(maxIterations), iteration_(0), finished_(false), rng_(std::move(rng)), greedyDone_(false),
+      neighborhood_(neighborhood)
+{
+    // A state handed over from an earlier search may already keep the table current
+    if (current_.neighborColors.empty())
+        current_.enableNeighborColorTable();
+    if (neighborhood_.kempeChains)
+        kempe_.reserve(current_.graph->numVertices());
+}
+
+bool HillClimbingColoringIterator::step()
+{
+    if (finished_ || iteration_ >= maxIterations_)
     {
         current_.continueIteration = false;
-        return current_;
+        return current_.continueIteration;
     }
+    StepScope scope(searchStats_);
 
-    auto bestV = selectNextNode(current_);
-    if (!bestV)
+    int bestV;
+    {
+        PhaseTimer timer(searchStats_.selectionNs);
+        bestV = selectNextNode(current_);
+    }
+    if (bestV < 0)
     {
         current_.continueIteration = false;
-        return current_;
+        return current_.continueIteration;
     }
 
-    int oldColor = current_.coloring[bestV].index;
+    int oldColor = current_.coloring[bestV];
     int oldH = current_.computeH();
     int bestH = oldH;
     int bestColor = oldColor;
     bool improved = false;
-    for (int c = 0; c < (int)current_.palette.size(); ++c)
     {
-        if (c == oldColor)
-            continue;
-        StateNode snapshot(current_.graph, current_.palette, current_.coloring, current_.conflicts, current_.usedColors);
-        snapshot.forward(current_.palette.getColor(c), bestV);
-        int newH = snapshot.computeH();
-        if (newH < bestH)
+        PhaseTimer timer(searchStats_.evaluationNs);
+        // Every candidate is scored from the neighbor color table, nothing is copied
+        const int *neighborColors = current_.neighborColorRow(bestV);
+        int otherConflicts = current_.conflicts - current_.nodeConflicts[bestV];
+        for (int c = 0; c < (int)current_.palette.size(); ++c)
         {
-            bestH = newH;
-            bestColor = c;
-            improved = true;
+            if (c == oldColor)
+                continue;
+            // After the move H is scored on color c, whose usage grows by one
+            int newH = (otherConflicts + neighborColors[c]) * 100 - (current_.usedColors[c] + 1);
+            if (newH < bestH)
+            {
+                bestH = newH;
+                bestColor = c;
+                improved = true;
+            }
+        }
+        countStat(searchStats_.movesEvaluated, current_.palette.size() - 1);
+    }
+    bool kempe = false;
+    if (!improved && neighborhood_.kempeChains)
+    {
+        // Stuck on a plateau: swap bestV's chain with whichever color improves H the most
+        PhaseTimer timer(searchStats_.evaluationNs);
+        for (int c = 0; c < (int)current_.palette.size(); ++c)
+        {
+            if (c == oldColor)
+                continue;
+            KempeMove move = kempe_.evaluate(current_, static_cast<VertexId>(bestV), c);
+            int newH = (current_.conflicts + move.conflictDelta) * 100 - (current_.usedColors[c] + move.fromCount - move.toCount);
+            if (newH < bestH)
+            {
+                bestH = newH;
+                bestColor = c;
+                improved = kempe = true;
+            }
         }
+        countStat(searchStats_.movesEvaluated, current_.palette.size() - 1);
     }
     if (improved)
     {
-        current_.forward(current_.palette.getColor(bestColor), bestV);
+        {
+            PhaseTimer timer(searchStats_.commitNs);
+            if (kempe)
+            {
+                kempe_.evaluate(current_, static_cast<VertexId>(bestV), bestColor);
+                kempe_.apply(current_, changeLog_);
+            }
+            else
+                current_.forward(bestColor, bestV);
+        }
+        countStat(searchStats_.movesAccepted);
+        if (changeLog_ && !kempe)
+            changeLog_->push_back(VertexChange{static_cast<VertexId>(bestV), oldColor, bestColor, current_.conflicts});
     }
     else
     {
@@ -169,252 +544,1262 @@ StateNode HillClimbingColoringIterator::step()
     }
     iteration_++;
     current_.node = bestV;
-    current_.color = current_.palette.getColor(bestColor);
+    current_.color = bestColor;
     current_.continueIteration = !finished_;
-    return current_;
+    return current_.continueIteration;
 }
 
-const ColoringMap &HillClimbingColoringIterator::getColoring() const { return current_.coloring; }
+const ColoringArray &HillClimbingColoringIterator::getColoring() const { return current_.coloring; }
 const StateNode &HillClimbingColoringIterator::getState() const { return current_; }
 
-SimulatedAnnealingColoringIterator::SimulatedAnnealingColoringIterator(std::unique_ptr<StateNode> initialState, int maxIterations, std::mt19937 rng)
-    : current_(std::move(*initialState)), maxIterations_(maxIterations), iteration_(1), finished_(false), rng_(std::move(rng)), greedyDone_(false)
+RepairResult HillClimbingColoringIterator::repair()
 {
+    RepairResult result = repairLogged(current_, changeLog_);
+    // forward() re-arms continueIteration
+    current_.continueIteration = !finished_;
+    return result;
 }
 
-StateNode SimulatedAnnealingColoringIterator::step()
+// Field by field: the struct has padding, which would otherwise leak into the checkpoint
+static void writeNeighborhood(CheckpointWriter &out, const NeighborhoodOptions &neighborhood)
 {
-    if (finished_)
+    out.write<std::uint8_t>(neighborhood.kempeChains);
+    out.write(neighborhood.kempeRate);
+}
+
+static NeighborhoodOptions readNeighborhood(CheckpointReader &in)
+{
+    NeighborhoodOptions neighborhood;
+    neighborhood.kempeChains = in.read<std::uint8_t>() != 0;
+    neighborhood.kempeRate = in.read<double>();
+    return neighborhood;
+}
+
+static void writeAnnealing(CheckpointWriter &out, const AnnealingOptions &options)
+{
+    out.write<std::uint8_t>(static_cast<std::uint8_t>(options.schedule));
+    out.write(options.initialTemperature);
+    out.write(options.finalTemperature);
+    out.write(options.targetAcceptance);
+    out.write(options.reheatFactor);
+}
+
+static AnnealingOptions readAnnealing(CheckpointReader &in)
+{
+    AnnealingOptions options;
+    auto schedule = in.read<std::uint8_t>();
+    if (schedule > static_cast<std::uint8_t>(CoolingSchedule::Adaptive))
+        throw std::runtime_error("Corrupt cooling schedule in checkpoint");
+    options.schedule = static_cast<CoolingSchedule>(schedule);
+    options.initialTemperature = in.read<double>();
+    options.finalTemperature = in.read<double>();
+    options.targetAcceptance = in.read<double>();
+    options.reheatFactor = in.read<double>();
+    return options;
+}
+
+void HillClimbingColoringIterator::saveState(CheckpointWriter &out) const
+{
+    out.write<std::int32_t>(iteration_);
+    out.write<std::uint8_t>(finished_);
+    out.writeEngine(rng_);
+    writeNeighborhood(out, neighborhood_);
+}
+
+void HillClimbingColoringIterator::restoreState(CheckpointReader &in)
+{
+    iteration_ = in.read<std::int32_t>();
+    finished_ = in.read<std::uint8_t>() != 0;
+    in.readEngine(rng_);
+    neighborhood_ = readNeighborhood(in);
+    if (neighborhood_.kempeChains)
+        kempe_.reserve(current_.graph->numVertices());
+    current_.continueIteration = !finished_;
+}
+
+void AcceptanceTable::setTemperature(double temperature, int maxDelta)
+{
+    temperature_ = temperature;
+    thresholds_.clear();
+    // Written so that a NaN (say, from a damaged checkpoint) also accepts nothing uphill
+    if (!(temperature > 0.0))
+        return;
+    // exp(-d / T) < 2^-32 once d > 32 ln(2) T
+    double cutoff = std::ceil(32.0 * std::log(2.0) * temperature);
+    int size = static_cast<int>(std::min(cutoff, static_cast<double>(maxDelta))) + 1;
+    for (int d = 0; d < size; ++d)
+        thresholds_.push_back(static_cast<std::uint32_t>(std::min(4294967295.0, std::exp(-d / temperature) * 4294967296.0)));
+}
+
+CoolingSchedule parseCoolingSchedule(const std::string &name)
+{
+    if (name == "geometric")
+        return CoolingSchedule::Geometric;
+    if (name == "linear")
+        return CoolingSchedule::Linear;
+    if (name == "logarithmic")
+        return CoolingSchedule::Logarithmic;
+    if (name == "adaptive")
+        return CoolingSchedule::Adaptive;
+    throw std::invalid_argument("Unknown cooling schedule: " + name);
+}
+
+const char *coolingScheduleName(CoolingSchedule schedule)
+{
+    switch (schedule)
     {
-        current_.continueIteration = false;
-        return current_;
+    case CoolingSchedule::Geometric:
+        return "geometric";
+    case CoolingSchedule::Linear:
+        return "linear";
+    case CoolingSchedule::Logarithmic:
+        return "logarithmic";
+    case CoolingSchedule::Adaptive:
+        return "adaptive";
     }
-    if (iteration_ > maxIterations_)
+    return "geometric";
+}
+
+SimulatedAnnealingColoringIterator::SimulatedAnnealingColoringIterator(std::unique_ptr<StateNode> initialState, int maxIterations, std::mt19937 rng, const AnnealingOptions &options, const NeighborhoodOptions &neighborhood)
+    : current_(std::move(*initialState)), maxIterations_(maxIterations), iteration_(1), finished_(false), rng_(std::move(rng)), greedyDone_(false),
+      options_(options), reheat_(1.0), uphillProposed_(0), uphillAccepted_(0), neighborhood_(neighborhood)
+{
+    // A recolor changes H by at most 100 per neighbor plus 1 for the usage term
+    maxDelta_ = static_cast<int>(current_.graph->maxDegree()) * 100 + 1;
+    stageLength_ = std::max(1, maxIterations_ / kStages);
+    beginStage(0);
+    if (neighborhood_.kempeChains)
+        kempe_.reserve(current_.graph->numVertices());
+}
+
+void SimulatedAnnealingColoringIterator::beginStage(int t)
+{
+    const double t0 = options_.initialTemperature;
+    const double tf = options_.finalTemperature;
+    const double progress = maxIterations_ > 0 ? std::min(1.0, static_cast<double>(t) / maxIterations_) : 1.0;
+    double temperature = t0;
+    switch (options_.schedule)
     {
-        finished_ = true;
+    case CoolingSchedule::Geometric:
+        temperature = t0 * std::pow(tf / t0, progress);
+        break;
+    case CoolingSchedule::Linear:
+        temperature = t0 + (tf - t0) * progress;
+        break;
+    case CoolingSchedule::Logarithmic:
+    {
+        double c = (t0 / tf - 1.0) / std::log1p(static_cast<double>(std::max(1, maxIterations_)));
+        temperature = t0 / (1.0 + c * std::log1p(static_cast<double>(t)));
+        break;
     }
-    double T = schedule_(iteration_);
-    if (T <= 1e-12)
+    case CoolingSchedule::Adaptive:
+        // Reheat while the last stage accepted too few uphill moves, cool back once it accepts plenty
+        if (uphillProposed_ > 0)
+        {
+            double rate = static_cast<double>(uphillAccepted_) / uphillProposed_;
+            if (rate < options_.targetAcceptance)
+                reheat_ *= options_.reheatFactor;
+            else if (rate > 2.0 * options_.targetAcceptance)
+                reheat_ = std::max(1.0, reheat_ / options_.reheatFactor);
+        }
+        temperature = t0 * std::pow(tf / t0, progress) * reheat_;
+        if (temperature > t0)
+        {
+            reheat_ = t0 / (temperature / reheat_);
+            temperature = t0;
+        }
+        break;
+    }
+    uphillProposed_ = 0;
+    uphillAccepted_ = 0;
+    acceptance_.setTemperature(temperature, maxDelta_);
+}
+
+bool SimulatedAnnealingColoringIterator::step()
+{
+    if (finished_ || iteration_ > maxIterations_)
     {
-        std::cout << "Temperature ~ 0, stopping.\n";
         finished_ = true;
+        current_.continueIteration = false;
+        return current_.continueIteration;
     }
-    if (finished_)
+    StepScope scope(searchStats_);
+    if (iteration_ > 1 && (iteration_ - 1) % stageLength_ == 0)
+        beginStage(iteration_ - 1);
+    int bestV;
     {
-        current_.continueIteration = false;
-        return current_;
+        PhaseTimer timer(searchStats_.selectionNs);
+        bestV = selectNextNode(current_);
     }
-    auto bestV = selectNextNode(current_);
-    if (!bestV)
+    if (bestV < 0)
     {
         finished_ = true;
         current_.continueIteration = false;
-        return current_;
+        return current_.continueIteration;
     }
-    int oldColorIdx = current_.coloring[bestV].index;
+    int oldColorIdx = current_.coloring[bestV];
     int selectedColorIdx = oldColorIdx;
-    std::uniform_int_distribution<int> dist(0, static_cast<int>(current_.palette.size() - 2));
-    int r = dist(rng_);
-    if (r >= oldColorIdx)
-        ++r;
-    selectedColorIdx = r;
-    int oldInc = countNodeConflicts(bestV, current_.coloring);
-    Color savedOldColor = current_.coloring[bestV];
-    int oldConflicts = current_.conflicts;
-    int oldH = current_.computeH();
-    current_.coloring[bestV] = current_.palette.getColor(selectedColorIdx);
-    int newInc = countNodeConflicts(bestV, current_.coloring);
-    int newConflicts = current_.conflicts - oldInc + newInc;
-    current_.conflicts = newConflicts;
-    current_.usedColors[oldColorIdx]--;
-    current_.usedColors[selectedColorIdx]++;
-    int newH = current_.computeH();
-    int dE = newH - oldH;
-    bool accept = false;
-    if (dE <= 0)
-    {
-        accept = true;
-    }
-    else
+    bool accept;
+    bool kempe = false;
     {
-        double acceptanceProb = std::exp(-static_cast<double>(dE) / T);
-        std::uniform_real_distribution<double> probDist(0.0, 1.0);
-        accept = (probDist(rng_) < acceptanceProb);
+        PhaseTimer timer(searchStats_.evaluationNs);
+        std::uniform_int_distribution<int> dist(0, static_cast<int>(current_.palette.size() - 2));
+        int r = dist(rng_);
+        if (r >= oldColorIdx)
+            ++r;
+        selectedColorIdx = r;
+        if (neighborhood_.kempeChains)
+            kempe = std::uniform_real_distribution<double>(0.0, 1.0)(rng_) < neighborhood_.kempeRate;
+        int dE;
+        if (kempe)
+        {
+            // Swap bestV's chain instead; H's usage term moves by the chain's net transfer
+            KempeMove move = kempe_.evaluate(current_, static_cast<VertexId>(bestV), selectedColorIdx);
+            int transfer = move.fromCount - move.toCount;
+            int usageShift = (current_.color == oldColorIdx ? transfer : 0) - (current_.color == selectedColorIdx ? transfer : 0);
+            dE = move.conflictDelta * 100 + usageShift;
+        }
+        else
+        {
+            // Evaluate the move without applying it: only bestV's neighbors are scanned
+            int oldInc = current_.nodeConflicts[bestV];
+            int newInc = countNeighborsWithColor(current_.graph->neighbors(bestV), current_.coloring.data(), selectedColorIdx, bestV);
+            // H is scored on the last applied color, whose usage shifts if it is the old or the new one
+            int usageShift = (current_.color == oldColorIdx ? 1 : 0) - (current_.color == selectedColorIdx ? 1 : 0);
+            dE = (newInc - oldInc) * 100 + usageShift;
+        }
+        accept = dE <= 0;
+        if (!accept)
+        {
+            accept = acceptance_.accept(dE, static_cast<std::uint32_t>(rng_()));
+            ++uphillProposed_;
+            if (accept)
+                ++uphillAccepted_;
+        }
+        countStat(searchStats_.movesEvaluated);
     }
-    if (!accept)
+    if (accept)
     {
-        current_.coloring[bestV] = savedOldColor;
-        current_.conflicts = oldConflicts;
-        current_.usedColors[selectedColorIdx]--;
-        current_.usedColors[oldColorIdx]++;
+        {
+            PhaseTimer timer(searchStats_.commitNs);
+            if (kempe)
+                kempe_.apply(current_, changeLog_);
+            else
+                current_.forward(selectedColorIdx, bestV);
+        }
+        countStat(searchStats_.movesAccepted);
+        if (changeLog_ && !kempe)
+            changeLog_->push_back(VertexChange{static_cast<VertexId>(bestV), oldColorIdx, selectedColorIdx, current_.conflicts});
     }
     iteration_++;
     current_.node = bestV;
-    current_.color = current_.palette.getColor(accept ? selectedColorIdx : oldColorIdx);
+    current_.color = accept ? selectedColorIdx : oldColorIdx;
     current_.continueIteration = !finished_;
-    return current_;
+    return current_.continueIteration;
 }
 
-const ColoringMap &SimulatedAnnealingColoringIterator::getColoring() const { return current_.coloring; }
+const ColoringArray &SimulatedAnnealingColoringIterator::getColoring() const { return current_.coloring; }
 const StateNode &SimulatedAnnealingColoringIterator::getState() const { return current_; }
-double SimulatedAnnealingColoringIterator::schedule_(int t) { return 100.0 * std::pow(0.95, t); }
 
-BeamColoringIterator::BeamColoringIterator(std::unique_ptr<StateNode> initialState, int maxIterations, std::mt19937 rng)
-    : k_(0), paletteSize_(0), maxIterations_(maxIterations), iteration_(0), finished_(false), rng_(std::move(rng)), greedyDone_(false)
+RepairResult SimulatedAnnealingColoringIterator::repair()
 {
-    StateNode start = std::move(*initialState);
-    std::cout << "Initial conflicts: " << start.conflicts << std::endl;
-    k_ = (start.palette.size() - 1) / 2;
-    paletteSize_ = start.palette.size();
-    beam_.reserve(k_);
-    beam_.push_back(std::move(start));
-    candidates_.reserve(k_ * paletteSize_);
+    RepairResult result = repairLogged(current_, changeLog_);
+    current_.continueIteration = !finished_;
+    return result;
+}
+
+void SimulatedAnnealingColoringIterator::saveState(CheckpointWriter &out) const
+{
+    out.write<std::int32_t>(iteration_);
+    out.write<std::uint8_t>(finished_);
+    out.writeEngine(rng_);
+    writeAnnealing(out, options_);
+    writeNeighborhood(out, neighborhood_);
+    out.write(acceptance_.temperature());
+    out.write(reheat_);
+    out.write<std::int32_t>(uphillProposed_);
+    out.write<std::int32_t>(uphillAccepted_);
+}
+
+void SimulatedAnnealingColoringIterator::restoreState(CheckpointReader &in)
+{
+    iteration_ = in.read<std::int32_t>();
+    finished_ = in.read<std::uint8_t>() != 0;
+    in.readEngine(rng_);
+    options_ = readAnnealing(in);
+    neighborhood_ = readNeighborhood(in);
+    if (neighborhood_.kempeChains)
+        kempe_.reserve(current_.graph->numVertices());
+    double temperature = in.read<double>();
+    reheat_ = in.read<double>();
+    uphillProposed_ = in.read<std::int32_t>();
+    uphillAccepted_ = in.read<std::int32_t>();
+    // The stage in progress keeps its temperature; later stages follow the restored options
+    acceptance_.setTemperature(temperature, maxDelta_);
+    current_.continueIteration = !finished_;
+}
+
+ParallelTemperingColoringIterator::ParallelTemperingColoringIterator(std::unique_ptr<StateNode> initialState, int maxIterations, std::mt19937 rng, unsigned numThreads, int numReplicas)
+    : best_(0), maxIterations_(maxIterations), iteration_(0), round_(0), finished_(false), rng_(std::move(rng)), pool_(numThreads)
+{
+    std::size_t count = numReplicas > 0 ? static_cast<std::size_t>(numReplicas) : std::max<std::size_t>(8, pool_.size());
+    replicas_.assign(count, *initialState);
+    conflicting_.resize(count);
+    for (std::size_t i = 0; i < count; ++i)
+        conflicting_[i].reset(replicas_[i]);
+    replicaRngs_.reserve(count);
+    replicaAt_.resize(count);
+    stats_.resize(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        replicaRngs_.emplace_back(rng_());
+        replicaAt_[i] = i;
+        double t = count > 1 ? static_cast<double>(i) / static_cast<double>(count - 1) : 0.0;
+        stats_[i].temperature = kMinTemperature * std::pow(kMaxTemperature / kMinTemperature, t);
+    }
+    acceptance_.resize(count);
+    int maxDelta = static_cast<int>(initialState->graph->maxDegree()) * 100;
+    for (std::size_t i = 0; i < count; ++i)
+        acceptance_[i].setTemperature(stats_[i].temperature, maxDelta);
+    workerStats_.resize(pool_.size());
 }
 
-StateNode BeamColoringIterator::step()
+bool ParallelTemperingColoringIterator::step()
 {
+    if (!finished_ && (iteration_ >= maxIterations_ || replicas_[best_].conflicts == 0 || replicas_[0].palette.size() < 2))
+        finished_ = true;
     if (finished_)
     {
-        if (!beam_.empty())
-            beam_[0].continueIteration = false;
-        return beam_.empty() ? StateNode() : beam_[0];
+        replicas_[best_].continueIteration = false;
+        return false;
     }
-    if (iteration_ >= maxIterations_)
+    StepScope scope(searchStats_);
+
+    // Every rung runs its chain independently; each rung is owned by exactly one worker
+    int moves = std::min(kRoundMoves, maxIterations_ - iteration_);
+    pool_.parallelFor(replicas_.size(), [&](std::size_t begin, std::size_t end, unsigned worker)
+                      {
+        SearchStats &local = workerStats_[worker];
+        AllocationScope allocations(local, worker != 0);
+        for (std::size_t rung = begin; rung < end; ++rung)
+        {
+            StateNode &state = replicas_[replicaAt_[rung]];
+            std::mt19937 &rng = replicaRngs_[replicaAt_[rung]];
+            ConflictingVertices &conflicting = conflicting_[replicaAt_[rung]];
+            ReplicaStats &stats = stats_[rung];
+            const AcceptanceTable &acceptance = acceptance_[rung];
+            // A one-color palette has no move to propose (step() finishes before getting here)
+            if (state.palette.size() < 2)
+                continue;
+            std::uniform_int_distribution<int> colorDist(0, static_cast<int>(state.palette.size()) - 2);
+            for (int move = 0; move < moves; ++move)
+            {
+                // Any conflicting vertex, uniformly: with the most conflicting one every chain
+                // would keep proposing moves of the same vertex, whatever its temperature
+                VertexId v;
+                {
+                    PhaseTimer timer(local.selectionNs);
+                    if (conflicting.empty())
+                        break;
+                    v = conflicting.sample(rng);
+                }
+                int newColor;
+                bool accept;
+                {
+                    PhaseTimer timer(local.evaluationNs);
+                    int oldColor = state.coloring[v];
+                    newColor = colorDist(rng);
+                    if (newColor >= oldColor)
+                        ++newColor;
+                    int newInc = countNeighborsWithColor(state.graph->neighbors(v), state.coloring.data(), newColor, v);
+                    int dE = (newInc - state.nodeConflicts[v]) * 100;
+                    accept = dE <= 0 || acceptance.accept(dE, static_cast<std::uint32_t>(rng()));
+                }
+                ++stats.proposed;
+                countStat(local.movesEvaluated);
+                if (accept)
+                {
+                    PhaseTimer timer(local.commitNs);
+                    state.forward(newColor, v);
+                    conflicting.updateAround(state, v);
+                    ++stats.accepted;
+                    countStat(local.movesAccepted);
+                }
+            }
+        } });
+    iteration_ += moves;
+
+    // Exchange chains between rungs (0,1), (2,3), ... on even rounds and (1,2), (3,4), ... on odd ones
+    std::uniform_real_distribution<double> probDist(0.0, 1.0);
+    for (std::size_t rung = round_ % 2; rung + 1 < replicas_.size(); rung += 2)
+    {
+        ReplicaStats &cold = stats_[rung];
+        const ReplicaStats &hot = stats_[rung + 1];
+        double coldEnergy = 100.0 * replicas_[replicaAt_[rung]].conflicts;
+        double hotEnergy = 100.0 * replicas_[replicaAt_[rung + 1]].conflicts;
+        double exponent = (1.0 / cold.temperature - 1.0 / hot.temperature) * (coldEnergy - hotEnergy);
+        ++cold.swapsProposed;
+        if (exponent >= 0.0 || probDist(rng_) < std::exp(exponent))
+        {
+            std::swap(replicaAt_[rung], replicaAt_[rung + 1]);
+            ++cold.swapsAccepted;
+        }
+    }
+    ++round_;
+
+    for (std::size_t i = 0; i < replicas_.size(); ++i)
     {
+        if (replicas_[i].conflicts < replicas_[best_].conflicts)
+            best_ = i;
+    }
+    if (changeLog_)
+        recordBestChanges();
+    if (replicas_[best_].conflicts == 0 || iteration_ >= maxIterations_)
         finished_ = true;
+    replicas_[best_].continueIteration = !finished_;
+    return !finished_;
+}
+
+void ParallelTemperingColoringIterator::setChangeLog(std::vector<VertexChange> *log)
+{
+    AlgorithmIterator::setChangeLog(log);
+    // Changes are logged relative to the coloring reported when recording starts
+    if (log)
+        reported_ = replicas_[best_].coloring;
+}
+
+void ParallelTemperingColoringIterator::recordBestChanges()
+{
+    const StateNode &best = replicas_[best_];
+    for (VertexId v = 0; v < reported_.size(); ++v)
+    {
+        if (reported_[v] == best.coloring[v])
+            continue;
+        changeLog_->push_back(VertexChange{v, reported_[v], best.coloring[v], best.conflicts});
+        reported_[v] = best.coloring[v];
+    }
+}
+
+SearchStats ParallelTemperingColoringIterator::searchStats() const
+{
+    SearchStats total = searchStats_;
+    for (const SearchStats &worker : workerStats_)
+        total += worker;
+    return total;
+}
+
+const ColoringArray &ParallelTemperingColoringIterator::getColoring() const { return replicas_[best_].coloring; }
+const StateNode &ParallelTemperingColoringIterator::getState() const { return replicas_[best_]; }
+
+RepairResult ParallelTemperingColoringIterator::repair()
+{
+    // Repair only lowers conflicts, so the repaired chain stays the best one
+    StateNode &state = replicas_[best_];
+    RepairResult result = repairConflicts(state);
+    conflicting_[best_].reset(state);
+    if (changeLog_)
+        recordBestChanges();
+    state.continueIteration = !finished_;
+    return result;
+}
+
+void ParallelTemperingColoringIterator::saveState(CheckpointWriter &out) const
+{
+    out.write<std::int32_t>(iteration_);
+    out.write<std::int32_t>(round_);
+    out.write<std::uint8_t>(finished_);
+    out.writeEngine(rng_);
+    out.write<std::uint64_t>(replicas_.size());
+    for (std::size_t i = 0; i < replicas_.size(); ++i)
+    {
+        out.writeArray(replicas_[i].coloring);
+        out.write<std::int32_t>(replicas_[i].node);
+        out.write<std::int32_t>(replicas_[i].color);
+        replicas_[i].conflictQueue.save(out);
+        out.writeArray(conflicting_[i].vertices());
+        out.writeEngine(replicaRngs_[i]);
+    }
+    std::vector<std::uint64_t> replicaAt(replicaAt_.begin(), replicaAt_.end());
+    out.writeArray(replicaAt);
+    out.writeArray(stats_);
+}
+
+void ParallelTemperingColoringIterator::restoreState(CheckpointReader &in)
+{
+    iteration_ = in.read<std::int32_t>();
+    round_ = in.read<std::int32_t>();
+    finished_ = in.read<std::uint8_t>() != 0;
+    in.readEngine(rng_);
+    auto count = in.read<std::uint64_t>();
+    // Every replica starts with an array length
+    if (count == 0 || count > in.remaining() / sizeof(std::uint64_t))
+        throw std::runtime_error("Inconsistent parallel tempering checkpoint");
+    std::shared_ptr<Graph> graph = replicas_[0].graph;
+    ColorPalette palette = replicas_[0].palette;
+    replicas_.clear();
+    replicaRngs_.resize(count);
+    conflicting_.resize(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        auto coloring = in.readArray<int>();
+        checkCheckpointColoring(coloring, graph->numVertices(), palette.size());
+        replicas_.push_back(stateFromColoring(graph, palette, ColoringArray(coloring.begin(), coloring.end())));
+        replicas_[i].node = in.read<std::int32_t>();
+        replicas_[i].color = in.read<std::int32_t>();
+        checkCheckpointNodeColor(replicas_[i].node, replicas_[i].color, graph->numVertices(), palette.size());
+        replicas_[i].conflictQueue.restore(in);
+        conflicting_[i].reset(replicas_[i]);
+        if (!conflicting_[i].restoreOrder(in.readArray<VertexId>()))
+            throw std::runtime_error("Inconsistent parallel tempering checkpoint");
+        in.readEngine(replicaRngs_[i]);
+    }
+    auto replicaAt = in.readArray<std::uint64_t>();
+    replicaAt_.assign(replicaAt.begin(), replicaAt.end());
+    stats_ = in.readVector<ReplicaStats>();
+    if (replicaAt_.size() != count || stats_.size() != count)
+        throw std::runtime_error("Inconsistent parallel tempering checkpoint");
+    acceptance_.resize(count);
+    int maxDelta = static_cast<int>(graph->maxDegree()) * 100;
+    for (std::size_t i = 0; i < count; ++i)
+        acceptance_[i].setTemperature(stats_[i].temperature, maxDelta);
+    best_ = 0;
+    for (std::size_t i = 1; i < count; ++i)
+    {
+        if (replicas_[i].conflicts < replicas_[best_].conflicts)
+            best_ = i;
     }
+    replicas_[best_].continueIteration = !finished_;
+}
+
+TabuColoringIterator::TabuColoringIterator(std::unique_ptr<StateNode> initialState, int maxIterations, std::mt19937 rng)
+    : current_(std::move(*initialState)), maxIterations_(maxIterations), iteration_(0), finished_(false), rng_(std::move(rng)), bestSnapshot_(false)
+{
+    if (current_.neighborColors.empty())
+        current_.enableNeighborColorTable();
+    std::size_t n = current_.graph->numVertices();
+    tabuUntil_.assign(n * current_.palette.size(), 0);
+    // Reserved up front so that steps never grow them
+    conflicting_.reset(current_);
+    sinceBest_.reserve(n + 1);
+    bestColoring_.reserve(n);
+    bestConflicts_ = current_.conflicts;
+}
+
+void TabuColoringIterator::applyMove(VertexId v, int color)
+{
+    int oldColor = current_.coloring[v];
+    current_.forward(color, v);
+    conflicting_.updateAround(current_, v);
+    current_.node = static_cast<int>(v);
+    current_.color = color;
+    if (changeLog_)
+        changeLog_->push_back(VertexChange{v, oldColor, color, current_.conflicts});
+}
+
+void TabuColoringIterator::finish()
+{
+    finished_ = true;
+    if (current_.conflicts > bestConflicts_)
+    {
+        if (bestSnapshot_)
+        {
+            for (VertexId v = 0; v < bestColoring_.size(); ++v)
+            {
+                if (current_.coloring[v] != bestColoring_[v])
+                    applyMove(v, bestColoring_[v]);
+            }
+        }
+        else
+        {
+            for (auto it = sinceBest_.rbegin(); it != sinceBest_.rend(); ++it)
+                applyMove(it->first, it->second);
+        }
+    }
+    sinceBest_.clear();
+    // forward() re-arms continueIteration, so this comes after the restore
+    current_.continueIteration = false;
+}
+
+bool TabuColoringIterator::step()
+{
+    if (!finished_ && (current_.conflicts == 0 || conflicting_.empty() || iteration_ >= maxIterations_ || current_.palette.size() < 2))
+        finish();
     if (finished_)
+        return current_.continueIteration;
+    StepScope scope(searchStats_);
+
+    // Best non-tabu recolor of a conflicting vertex; ties are broken uniformly at random
+    const int k = static_cast<int>(current_.palette.size());
+    int bestDelta = INT_MAX;
+    VertexId bestV = 0;
+    int bestColor = -1;
+    unsigned ties = 0;
     {
-        if (!beam_.empty())
-            beam_[0].continueIteration = false;
-        return beam_.empty() ? StateNode() : beam_[0];
+        // Selection and evaluation are one pass here: every move of every conflicting vertex is scored
+        PhaseTimer timer(searchStats_.evaluationNs);
+        for (VertexId v : conflicting_.vertices())
+        {
+            const int *row = current_.neighborColorRow(v);
+            const int *tabu = tabuUntil_.data() + static_cast<std::size_t>(v) * k;
+            int from = current_.coloring[v];
+            for (int c = 0; c < k; ++c)
+            {
+                int delta = row[c] - row[from];
+                if (c == from || delta > bestDelta)
+                    continue;
+                if (tabu[c] > iteration_ && current_.conflicts + delta >= bestConflicts_)
+                    continue;
+                if (delta < bestDelta)
+                {
+                    bestDelta = delta;
+                    ties = 0;
+                }
+                if (rng_() % ++ties == 0)
+                {
+                    bestV = v;
+                    bestColor = c;
+                }
+            }
+        }
+        countStat(searchStats_.movesEvaluated, conflicting_.size() * static_cast<std::size_t>(k - 1));
     }
-    for (auto &current : beam_)
+
+    ++iteration_;
+    if (bestColor >= 0)
     {
-        auto bestV = selectNextNode(current);
-        if (!bestV)
+        int from = current_.coloring[bestV];
+        int tenure = static_cast<int>(rng_() % kTenureRandom) + static_cast<int>(kTenureFactor * conflicting_.size());
+        tabuUntil_[static_cast<std::size_t>(bestV) * k + from] = iteration_ + tenure;
+        {
+            PhaseTimer timer(searchStats_.commitNs);
+            applyMove(bestV, bestColor);
+        }
+        countStat(searchStats_.movesAccepted);
+
+        if (current_.conflicts < bestConflicts_)
+        {
+            bestConflicts_ = current_.conflicts;
+            sinceBest_.clear();
+            bestSnapshot_ = false;
+        }
+        else if (!bestSnapshot_)
+        {
+            sinceBest_.emplace_back(bestV, from);
+            if (sinceBest_.size() > current_.coloring.size())
+            {
+                bestColoring_ = current_.coloring;
+                countStat(searchStats_.bytesCopied, bestColoring_.size() * sizeof(int));
+                for (auto it = sinceBest_.rbegin(); it != sinceBest_.rend(); ++it)
+                    bestColoring_[it->first] = it->second;
+                sinceBest_.clear();
+                bestSnapshot_ = true;
+            }
+        }
+    }
+
+    if (current_.conflicts == 0 || iteration_ >= maxIterations_)
+        finish();
+    else
+        current_.continueIteration = true;
+    return current_.continueIteration;
+}
+
+const ColoringArray &TabuColoringIterator::getColoring() const { return current_.coloring; }
+const StateNode &TabuColoringIterator::getState() const { return current_; }
+
+RepairResult TabuColoringIterator::repair()
+{
+    // sinceBest_ cannot undo the repair's recolors, so a best coloring the current one has left
+    // behind is snapshotted first
+    if (current_.conflicts > bestConflicts_ && !bestSnapshot_)
+    {
+        bestColoring_ = current_.coloring;
+        for (auto it = sinceBest_.rbegin(); it != sinceBest_.rend(); ++it)
+            bestColoring_[it->first] = it->second;
+        sinceBest_.clear();
+        bestSnapshot_ = true;
+    }
+    RepairResult result = repairLogged(current_, changeLog_);
+    conflicting_.reset(current_);
+    if (current_.conflicts <= bestConflicts_)
+    {
+        bestConflicts_ = current_.conflicts;
+        sinceBest_.clear();
+        bestSnapshot_ = false;
+    }
+    current_.continueIteration = !finished_;
+    return result;
+}
+
+void TabuColoringIterator::saveState(CheckpointWriter &out) const
+{
+    out.write<std::int32_t>(iteration_);
+    out.write<std::uint8_t>(finished_);
+    out.writeEngine(rng_);
+    out.writeArray(tabuUntil_);
+    out.write<std::int32_t>(bestConflicts_);
+    // Candidates are scanned in list order, which decides random tie-breaks
+    out.writeArray(conflicting_.vertices());
+    // The best coloring is stored in full, or not at all while the current one is the best
+    ColoringArray best;
+    if (current_.conflicts > bestConflicts_)
+    {
+        if (bestSnapshot_)
+            best = bestColoring_;
+        else
+        {
+            best = current_.coloring;
+            for (auto it = sinceBest_.rbegin(); it != sinceBest_.rend(); ++it)
+                best[it->first] = it->second;
+        }
+    }
+    out.writeArray(best);
+}
+
+void TabuColoringIterator::restoreState(CheckpointReader &in)
+{
+    iteration_ = in.read<std::int32_t>();
+    finished_ = in.read<std::uint8_t>() != 0;
+    in.readEngine(rng_);
+    tabuUntil_ = in.readVector<int>();
+    bestConflicts_ = in.read<std::int32_t>();
+    auto conflicting = in.readArray<VertexId>();
+    bestColoring_ = in.readVector<int>();
+    if (!bestColoring_.empty())
+        checkCheckpointColoring(bestColoring_, current_.coloring.size(), current_.palette.size());
+    bestSnapshot_ = !bestColoring_.empty();
+    sinceBest_.clear();
+    if (tabuUntil_.size() != current_.coloring.size() * current_.palette.size() || !conflicting_.restoreOrder(conflicting))
+        throw std::runtime_error("Inconsistent tabu checkpoint");
+    current_.continueIteration = !finished_;
+}
+
+BeamColoringIterator::BeamColoringIterator(std::unique_ptr<StateNode> initialState, int maxIterations, std::mt19937 rng, unsigned numThreads)
+    : k_(0), paletteSize_(0), maxIterations_(maxIterations), iteration_(0), finished_(false), rng_(std::move(rng)), greedyDone_(false), pool_(numThreads), bestDirty_(true)
+{
+    auto start = std::make_shared<const StateNode>(std::move(*initialState));
+    // Palettes of 2 or fewer colors (a k-1 start from a 3-coloring) still keep one member
+    k_ = std::max((start->palette.size() - 1) / 2, 1);
+    paletteSize_ = start->palette.size();
+    // A proper start has nothing to expand
+    finished_ = start->conflicts == 0;
+    beam_.reserve(k_);
+    nextBeam_.reserve(k_);
+    beam_.push_back(BeamMember{start, {}, start->node, start->color, start->conflicts, start->computeH()});
+    for (auto &half : moveArena_)
+        half.resize(static_cast<std::size_t>(k_) * kMaxMoves);
+    // Between a step's first fold and the swap, the parents' bases (at most k_, the reported one
+    // among them) and one freshly folded base per parent are live at once. Every pooled base is
+    // a copy of the start, so folding into it and materializing best_ reuse buffers of the final size.
+    basePool_.reserve(2 * static_cast<std::size_t>(k_));
+    for (int i = 0; i < 2 * k_; ++i)
+        basePool_.push_back(std::make_shared<StateNode>(*start));
+    best_ = *start;
+    rebased_.reserve(k_);
+    candidates_.reserve(k_ * k_);
+    candidateCounts_.reserve(k_);
+    memberSeeds_.reserve(k_);
+    kLeastBuffers_.winners.reserve(pool_.size());
+    kLeastBuffers_.merged.reserve(static_cast<std::size_t>(k_) * pool_.size());
+    reportedMoves_.reserve(kMaxMoves);
+    std::size_t numVertices = start->graph->numVertices();
+    scratch_.resize(pool_.size());
+    for (Scratch &scratch : scratch_)
+    {
+        scratch.overlayColor.assign(numVertices, -1);
+        scratch.touched.assign(numVertices, 0);
+        scratch.touchedList.reserve(numVertices);
+        scratch.usage.reserve(paletteSize_);
+        scratch.neighborColorCount.assign(paletteSize_, 0);
+        scratch.colorOrder.resize(paletteSize_);
+    }
+}
+
+void BeamColoringIterator::materialize(const BeamMember &member, StateNode &out) const
+{
+    // Copy-assignment reuses out's vectors, so only the first materialization into out allocates
+    out = *member.base;
+    for (const BeamMove &move : member.moves)
+        out.forward(move.to, move.vertex);
+    out.node = member.node;
+    out.color = member.color;
+}
+
+std::shared_ptr<StateNode> BeamColoringIterator::acquireBase()
+{
+    for (const auto &base : basePool_)
+    {
+        if (base.use_count() == 1)
+            return base;
+    }
+    basePool_.push_back(std::make_shared<StateNode>());
+    return basePool_.back();
+}
+
+int BeamColoringIterator::expandMember(int memberIndex, Scratch &scratch, std::uint32_t seed, BeamCandidate *out) const
+{
+    const BeamMember &member = beam_[memberIndex];
+    const StateNode &base = *member.base;
+    const Graph &graph = *base.graph;
+    std::optional<PhaseTimer> timer(std::in_place, scratch.stats.selectionNs);
+
+    // Overlay the member's moves onto the shared base: colors, usage and the set of
+    // vertices whose conflict count may differ from the base counters
+    scratch.usage = base.usedColors;
+    countStat(scratch.stats.bytesCopied, base.usedColors.size() * sizeof(int));
+    for (const BeamMove &move : member.moves)
+    {
+        scratch.overlayColor[move.vertex] = move.to;
+        scratch.usage[move.from]--;
+        scratch.usage[move.to]++;
+        if (!scratch.touched[move.vertex])
+        {
+            scratch.touched[move.vertex] = 1;
+            scratch.touchedList.push_back(move.vertex);
+        }
+        for (VertexId nbr : graph.neighbors(move.vertex))
+        {
+            if (!scratch.touched[nbr])
+            {
+                scratch.touched[nbr] = 1;
+                scratch.touchedList.push_back(nbr);
+            }
+        }
+    }
+    auto colorOf = [&](VertexId v)
+    {
+        return scratch.overlayColor[v] >= 0 ? scratch.overlayColor[v] : base.coloring[v];
+    };
+
+    // Touched vertices are recounted; the rest keep their base counters and come from the base queue
+    int bestV = base.conflictQueue.selectWhere(scratch.usage, [&](VertexId v)
+                                               { return scratch.touched[v] != 0; });
+    int bestIncident = bestV >= 0 ? base.nodeConflicts[bestV] : 0;
+    int bestColorUse = bestV >= 0 ? scratch.usage[base.coloring[bestV]] : INT_MAX;
+    for (VertexId v : scratch.touchedList)
+    {
+        int vcol = colorOf(v);
+        int incident = 0;
+        for (VertexId nbr : graph.neighbors(v))
+        {
+            if (nbr != v && colorOf(nbr) == vcol)
+                ++incident;
+        }
+        if (incident == 0)
             continue;
-        int oldColor = current.coloring[bestV].index;
-        int oldInc = countNodeConflicts(bestV, current.coloring);
-        int oldH = current.computeH();
-        std::shuffle(current.palette.begin(), current.palette.end(), rng_);
-        for (int c = 0; c < k_; ++c)
+        if (incident > bestIncident || (incident == bestIncident && scratch.usage[vcol] < bestColorUse))
+        {
+            bestIncident = incident;
+            bestColorUse = scratch.usage[vcol];
+            bestV = static_cast<int>(v);
+        }
+    }
+
+    timer.emplace(scratch.stats.evaluationNs);
+
+    int count = 0;
+    if (bestV >= 0)
+    {
+        VertexId v = static_cast<VertexId>(bestV);
+        int oldColor = colorOf(v);
+        for (VertexId nbr : graph.neighbors(v))
         {
+            if (nbr != v)
+                scratch.neighborColorCount[colorOf(nbr)]++;
+        }
+        // Each member shuffles from the identity with its own seed, independent of which thread runs it
+        std::vector<int> &colorOrder = scratch.colorOrder;
+        for (int c = 0; c < paletteSize_; ++c)
+            colorOrder[c] = c;
+        std::mt19937 rng(seed);
+        std::shuffle(colorOrder.begin(), colorOrder.end(), rng);
+        for (int i = 0; i < std::min(k_, paletteSize_); ++i)
+        {
+            int c = colorOrder[i];
             if (c == oldColor)
                 continue;
-            ColoringMap newColoring(current.coloring);
-            newColoring[bestV] = current.palette.getColor(c);
-            UsedColorsMap newUsedColors(current.usedColors);
-            newUsedColors[oldColor]--;
-            newUsedColors[c]++;
-            int newInc = countNodeConflicts(bestV, newColoring);
-            int newConflicts = current.conflicts - oldInc + newInc;
-            StateNode newState(
-                current.graph,
-                current.palette,
-                std::move(newColoring),
-                newConflicts,
-                std::move(newUsedColors));
-            newState.node = bestV;
-            newState.color = current.palette.getColor(c);
-            newState.conflicts = newConflicts;
-            newState.continueIteration = true;
-            candidates_.push_back(std::move(newState));
-        }
-    }
-    beam_ = kLeast(candidates_, k_);
+            int newConflicts = member.conflicts - bestIncident + scratch.neighborColorCount[c];
+            // After the move H is scored on color c, whose usage grows by one
+            int h = newConflicts * 100 - (scratch.usage[c] + 1);
+            out[count++] = BeamCandidate{memberIndex, v, c, newConflicts, h};
+        }
+        for (VertexId nbr : graph.neighbors(v))
+            scratch.neighborColorCount[colorOf(nbr)] = 0;
+        countStat(scratch.stats.movesEvaluated, static_cast<std::uint64_t>(count));
+    }
+
+    for (const BeamMove &move : member.moves)
+        scratch.overlayColor[move.vertex] = -1;
+    for (VertexId v : scratch.touchedList)
+        scratch.touched[v] = 0;
+    scratch.touchedList.clear();
+    return count;
+}
+
+bool BeamColoringIterator::step()
+{
+    if (finished_)
+        return false;
+    if (iteration_ >= maxIterations_)
+    {
+        finished_ = true;
+        return false;
+    }
+    StepScope scope(searchStats_);
+    // Members expand independently into their own slice of candidates_
+    int members = static_cast<int>(beam_.size());
+    memberSeeds_.resize(members);
+    for (int i = 0; i < members; ++i)
+        memberSeeds_[i] = static_cast<std::uint32_t>(rng_());
+    candidates_.resize(static_cast<std::size_t>(members) * k_);
+    candidateCounts_.assign(members, 0);
+    pool_.parallelFor(members, [&](std::size_t begin, std::size_t end, unsigned worker)
+                      {
+        AllocationScope allocations(scratch_[worker].stats, worker != 0);
+        for (std::size_t i = begin; i < end; ++i)
+            candidateCounts_[i] = expandMember(static_cast<int>(i), scratch_[worker], memberSeeds_[i], candidates_.data() + i * k_); });
+    std::size_t filled = 0;
+    for (int i = 0; i < members; ++i)
+    {
+        for (int j = 0; j < candidateCounts_[i]; ++j)
+            candidates_[filled++] = candidates_[static_cast<std::size_t>(i) * k_ + j];
+    }
+    candidates_.resize(filled);
+
+    // Build only the survivors: each one extends its parent's move list by one move,
+    // and parents whose list is full are folded into a new base shared by their children
+    {
+        PhaseTimer timer(searchStats_.kLeastNs);
+        kLeast(candidates_, k_, pool_, kLeastBuffers_);
+    }
+    const std::vector<BeamCandidate> &survivors = kLeastBuffers_.merged;
     candidates_.clear();
-    for (int i = 0; i < (int)beam_.size(); ++i)
+    if (survivors.empty())
     {
-        if (beam_[i].conflicts == 0)
+        // No member has a move left (a one-color palette); the current beam stays the result
+        finished_ = true;
+        return false;
+    }
+    std::optional<PhaseTimer> commitTimer(std::in_place, searchStats_.commitNs);
+    rebased_.assign(beam_.size(), nullptr);
+    nextBeam_.clear();
+    for (const BeamCandidate &cand : survivors)
+    {
+        const BeamMember &parent = beam_[cand.parent];
+        int from = parent.base->coloring[cand.vertex];
+        for (const BeamMove &move : parent.moves)
         {
-            std::cout << "Found conflict-free coloring in beam at iteration " << iteration_ << "\n";
-            finished_ = true;
-            break;
+            if (move.vertex == cand.vertex)
+                from = move.to;
+        }
+        BeamMember child{parent.base, {}, static_cast<int>(cand.vertex), cand.color, cand.conflicts, cand.h};
+        BeamMove *slot = moveSlot(iteration_ + 1, nextBeam_.size());
+        std::size_t kept = 0;
+        if (parent.moves.size() >= kMaxMoves)
+        {
+            if (!rebased_[cand.parent])
+            {
+                std::shared_ptr<StateNode> base = acquireBase();
+                materialize(parent, *base);
+                countStat(searchStats_.bytesCopied, base->footprintBytes());
+                rebased_[cand.parent] = std::move(base);
+            }
+            child.base = rebased_[cand.parent];
+        }
+        else
+        {
+            kept = parent.moves.size();
+            std::copy(parent.moves.begin(), parent.moves.end(), slot);
+            countStat(searchStats_.bytesCopied, kept * sizeof(BeamMove));
         }
+        slot[kept] = BeamMove{cand.vertex, from, cand.color};
+        child.moves = {slot, kept + 1};
+        nextBeam_.push_back(std::move(child));
     }
+    countStat(searchStats_.movesAccepted, nextBeam_.size());
+    std::swap(beam_, nextBeam_);
+    // Parents must not keep bases alive, or the pool could never hand them out again
+    nextBeam_.clear();
+    rebased_.clear();
+    commitTimer.reset();
+    bestDirty_ = true;
     iteration_++;
-    if (finished_ && !beam_.empty())
+
+    // Keep the member with the fewest conflicts in front, it is the one reported
+    auto best = std::min_element(beam_.begin(), beam_.end(), [](const BeamMember &a, const BeamMember &b)
+                                 { return a.conflicts != b.conflicts ? a.conflicts < b.conflicts : a.h < b.h; });
+    std::iter_swap(beam_.begin(), best);
+    if (changeLog_)
+        recordBestChanges();
+    if (beam_[0].conflicts == 0)
+        finished_ = true;
+    return !finished_;
+}
+
+void BeamColoringIterator::setChangeLog(std::vector<VertexChange> *log)
+{
+    AlgorithmIterator::setChangeLog(log);
+    if (!log)
+        return;
+    // Changes are logged relative to the coloring reported when recording starts
+    reported_ = getState().coloring;
+    reportedBase_ = beam_[0].base;
+    reportedMoves_.assign(beam_[0].moves.begin(), beam_[0].moves.end());
+}
+
+void BeamColoringIterator::recordBestChanges()
+{
+    const BeamMember &best = beam_[0];
+    auto logIfChanged = [&](VertexId v, int color)
+    {
+        if (reported_[v] == color)
+            return;
+        changeLog_->push_back(VertexChange{v, reported_[v], color, best.conflicts});
+        reported_[v] = color;
+    };
+    if (best.base == reportedBase_)
     {
-        std::cout << "Final conflicts: " << beam_[0].conflicts << "\n";
+        // Same base: only vertices moved by either member can differ
+        auto colorInBest = [&](VertexId v)
+        {
+            int color = best.base->coloring[v];
+            for (const BeamMove &move : best.moves)
+            {
+                if (move.vertex == v)
+                    color = move.to;
+            }
+            return color;
+        };
+        for (const BeamMove &move : reportedMoves_)
+            logIfChanged(move.vertex, colorInBest(move.vertex));
+        for (const BeamMove &move : best.moves)
+            logIfChanged(move.vertex, colorInBest(move.vertex));
     }
-    if (!beam_.empty())
-        beam_[0].continueIteration = !finished_;
-    return beam_.empty() ? StateNode() : beam_[0];
+    else
+    {
+        // The best lineage was folded into a new base (at most once per kMaxMoves steps)
+        const StateNode &state = getState();
+        for (VertexId v = 0; v < state.coloring.size(); ++v)
+            logIfChanged(v, state.coloring[v]);
+    }
+    reportedBase_ = best.base;
+    reportedMoves_.assign(best.moves.begin(), best.moves.end());
 }
 
-const ColoringMap &BeamColoringIterator::getColoring() const
+SearchStats BeamColoringIterator::searchStats() const
 {
-    if (beam_.empty())
-        throw std::runtime_error("Beam is empty");
-    return beam_[0].coloring;
+    SearchStats total = searchStats_;
+    for (const Scratch &scratch : scratch_)
+        total += scratch.stats;
+    return total;
+}
+
+const ColoringArray &BeamColoringIterator::getColoring() const
+{
+    return getState().coloring;
 }
 const StateNode &BeamColoringIterator::getState() const
 {
-    if (beam_.empty())
-        throw std::runtime_error("Beam is empty");
-    return beam_[0];
+    if (bestDirty_)
+    {
+        materialize(beam_[0], best_);
+        best_.continueIteration = !finished_;
+        bestDirty_ = false;
+    }
+    return best_;
 }
 
-int partition(std::vector<StateNode> &arr, int left, int right)
+RepairResult BeamColoringIterator::repair()
 {
-    // Last element is chosen as a pivot.
-    int pivotH = arr[right].computeH();
-    int i = left;
+    // The repaired best member becomes the whole beam, on a base of its own; the others ranked
+    // below it even before the repair
+    std::shared_ptr<StateNode> base = acquireBase();
+    materialize(beam_[0], *base);
+    RepairResult result = repairConflicts(*base);
+    beam_.clear();
+    beam_.push_back(BeamMember{base, {}, base->node, base->color, base->conflicts, base->computeH()});
+    bestDirty_ = true;
+    if (base->conflicts == 0)
+        finished_ = true;
+    if (changeLog_)
+        recordBestChanges();
+    return result;
+}
 
-    for (int j = left; j < right; j++)
+void BeamColoringIterator::saveState(CheckpointWriter &out) const
+{
+    out.write<std::int32_t>(iteration_);
+    out.write<std::uint8_t>(finished_);
+    out.writeEngine(rng_);
+    // Members share bases, so each distinct base is written once and referenced by index
+    std::vector<const StateNode *> bases;
+    std::vector<std::uint32_t> baseOf;
+    for (const BeamMember &member : beam_)
     {
-        if (arr[j].computeH() <= pivotH)
+        auto it = std::find(bases.begin(), bases.end(), member.base.get());
+        baseOf.push_back(static_cast<std::uint32_t>(it - bases.begin()));
+        if (it == bases.end())
+            bases.push_back(member.base.get());
+    }
+    out.write<std::uint64_t>(bases.size());
+    for (const StateNode *base : bases)
+    {
+        out.writeArray(base->coloring);
+        out.write<std::int32_t>(base->node);
+        out.write<std::int32_t>(base->color);
+        base->conflictQueue.save(out);
+    }
+    out.write<std::uint64_t>(beam_.size());
+    for (std::size_t i = 0; i < beam_.size(); ++i)
+    {
+        const BeamMember &member = beam_[i];
+        out.write(baseOf[i]);
+        out.writeArray(member.moves);
+        out.write<std::int32_t>(member.node);
+        out.write<std::int32_t>(member.color);
+        out.write<std::int32_t>(member.conflicts);
+        out.write<std::int32_t>(member.h);
+    }
+}
+
+void BeamColoringIterator::restoreState(CheckpointReader &in)
+{
+    iteration_ = in.read<std::int32_t>();
+    finished_ = in.read<std::uint8_t>() != 0;
+    in.readEngine(rng_);
+    std::shared_ptr<Graph> graph = beam_[0].base->graph;
+    ColorPalette palette = beam_[0].base->palette;
+    auto numBases = in.read<std::uint64_t>();
+    // Bases are shared by members, so there are never more of them than members
+    if (numBases == 0 || numBases > static_cast<std::uint64_t>(k_))
+        throw std::runtime_error("Inconsistent beam checkpoint");
+    std::vector<std::shared_ptr<const StateNode>> bases(numBases);
+    for (auto &base : bases)
+    {
+        auto coloring = in.readArray<int>();
+        checkCheckpointColoring(coloring, graph->numVertices(), palette.size());
+        StateNode state = stateFromColoring(graph, palette, ColoringArray(coloring.begin(), coloring.end()));
+        state.node = in.read<std::int32_t>();
+        state.color = in.read<std::int32_t>();
+        checkCheckpointNodeColor(state.node, state.color, graph->numVertices(), palette.size());
+        state.conflictQueue.restore(in);
+        base = std::make_shared<const StateNode>(std::move(state));
+    }
+    beam_.clear();
+    auto members = static_cast<std::size_t>(in.read<std::uint64_t>());
+    if (members == 0 || members > static_cast<std::size_t>(k_))
+        throw std::runtime_error("Inconsistent beam checkpoint");
+    for (std::size_t i = 0; i < members; ++i)
+    {
+        auto baseIndex = in.read<std::uint32_t>();
+        auto moves = in.readArray<BeamMove>();
+        if (baseIndex >= bases.size() || moves.size() > kMaxMoves || (!moves.empty() && i >= static_cast<std::size_t>(k_)))
+            throw std::runtime_error("Inconsistent beam checkpoint");
+        for (const BeamMove &move : moves)
         {
-            std::swap(arr[i], arr[j]);
-            i++;
+            if (move.vertex >= graph->numVertices() || move.from < 0 || move.from >= palette.size() || move.to < 0 || move.to >= palette.size())
+                throw std::runtime_error("Corrupt vertex or color in checkpoint");
         }
+        BeamMove *slot = moveSlot(iteration_, i);
+        std::copy(moves.begin(), moves.end(), slot);
+        BeamMember member{bases[baseIndex], {slot, moves.size()}, 0, 0, 0, 0};
+        member.node = in.read<std::int32_t>();
+        member.color = in.read<std::int32_t>();
+        member.conflicts = in.read<std::int32_t>();
+        member.h = in.read<std::int32_t>();
+        checkCheckpointNodeColor(member.node, member.color, graph->numVertices(), palette.size());
+        beam_.push_back(std::move(member));
     }
+    bestDirty_ = true;
+}
+
+void kLeast(std::vector<BeamCandidate> &arr, int k, ThreadPool &pool, KLeastBuffers &buffers)
+{
+    std::vector<BeamCandidate> &merged = buffers.merged;
+    merged.clear();
+    std::size_t n = arr.size();
+    std::size_t keep = std::min<std::size_t>(std::max(k, 0), n);
+    if (keep == 0)
+        return;
 
-    std::swap(arr[i], arr[right]);
+    // Every slice moves its own `keep` best to its front; the global top-k is among those
+    auto &winners = buffers.winners;
+    winners.assign(pool.size(), {0, 0});
+    pool.parallelFor(n, [&](std::size_t begin, std::size_t end, unsigned worker)
+                     {
+        auto first = arr.begin() + begin;
+        auto last = arr.begin() + end;
+        std::size_t sliceKeep = std::min(keep, end - begin);
+        if (sliceKeep < end - begin)
+            std::nth_element(first, first + sliceKeep, last, beamCandidateLess);
+        winners[worker] = {begin, sliceKeep}; });
 
-    return i;
+    for (const auto &[begin, count] : winners)
+        merged.insert(merged.end(), arr.begin() + begin, arr.begin() + begin + count);
+    if (merged.size() > keep)
+        std::nth_element(merged.begin(), merged.begin() + keep, merged.end(), beamCandidateLess);
+    merged.resize(keep);
+    std::sort(merged.begin(), merged.end(), beamCandidateLess);
 }
 
-void quickSelect(std::vector<StateNode> &arr, int left, int right, int k)
+StateNode initialStateNode(std::shared_ptr<Graph> graph, std::mt19937 &rng, const InitialColoringOptions &options)
 {
-    if (left <= right)
+    if (options.method != InitialColoring::Random)
     {
-        int pivotIdx = partition(arr, left, right);
-
-        // Count of all elements in the left part
-        int leftCnt = pivotIdx - left + 1;
+        ColoringArray coloring = constructiveColoring(*graph, options.method);
+        int numColors = coloring.empty() ? 1 : *std::max_element(coloring.begin(), coloring.end()) + 1;
+        if (options.oneColorFewer)
+            numColors = dropLastColor(*graph, coloring, numColors);
+        return stateFromColoring(std::move(graph), ColorPalette(numColors), std::move(coloring));
+    }
 
-        // If leftCnt is equal to k, then we have
-        // found the k largest element
-        if (leftCnt == k)
-            return;
+    // compute maxDegree once
+    int maxDegree = static_cast<int>(graph->maxDegree());
 
-        // Search in the left subarray
-        if (leftCnt > k)
-            quickSelect(arr, left, pivotIdx - 1, k);
+    ColorPalette palette(maxDegree + 1); // enough colors for any node's incident edges
 
-        // Reduce the k by number of elements already covered
-        // and search in the right subarray
-        else
-            quickSelect(arr, pivotIdx + 1, right, k - leftCnt);
+    ColoringArray coloring(graph->numVertices());
+    UsedColorsArray usedColors(palette.size(), 0);
+    std::uniform_int_distribution<int> colorDist(0, static_cast<int>(palette.size()) - 1);
+    for (VertexId node = 0; node < graph->numVertices(); ++node)
+    {
+        coloring[node] = colorDist(rng);
+        usedColors[coloring[node]]++;
     }
+
+    int conflicts = computeConflicts(*graph, coloring);
+    return StateNode{std::move(graph), std::move(palette), std::move(coloring), conflicts, std::move(usedColors)};
 }
 
-std::vector<StateNode> kLeast(std::vector<StateNode> &arr, int k)
+StateNode initialStateNode(const RandomGraphOptions &options, std::mt19937 &rng, const InitialColoringOptions &initialColoring)
 {
-    int n = arr.size();
-    if (k > n)
-        k = n;
-
-    quickSelect(arr, 0, n - 1, k);
+    return initialStateNode(std::make_shared<Graph>(generateRandomGraph(options, rng)), rng, initialColoring);
+}
 
-    // Move the first k elements to a new vector
-    std::vector<StateNode> res;
-    res.reserve(k);
-    for (int i = 0; i < k; ++i)
+std::unique_ptr<AlgorithmIterator> initializeAlgorithm(std::unique_ptr<StateNode> initialState, const std::string &algorithmName, int iterations, std::mt19937 rng, unsigned numThreads, const AnnealingOptions &annealing, const NeighborhoodOptions &neighborhood)
+{
+    if (algorithmName == "hill_climbing")
+    {
+        return std::make_unique<HillClimbingColoringIterator>(std::move(initialState), iterations, std::move(rng), neighborhood);
+    }
+    else if (algorithmName == "simulated_annealing")
+    {
+        return std::make_unique<SimulatedAnnealingColoringIterator>(std::move(initialState), iterations, std::move(rng), annealing, neighborhood);
+    }
+    else if (algorithmName == "parallel_tempering")
+    {
+        return std::make_unique<ParallelTemperingColoringIterator>(std::move(initialState), iterations, std::move(rng), numThreads);
+    }
+    else if (algorithmName == "tabu")
+    {
+        return std::make_unique<TabuColoringIterator>(std::move(initialState), iterations, std::move(rng));
+    }
+    else if (algorithmName == "beam")
     {
-        res.push_back(std::move(arr[i]));
+        return std::make_unique<BeamColoringIterator>(std::move(initialState), iterations, std::move(rng), numThreads);
     }
-    return res;
-}
\ No newline at end of file
+    else
+    {
+        throw std::invalid_argument("Unknown algorithm name: " + algorithmName);
+    }
+}
@@ -2,16 +2,23 @@
 #define ALGORITHM_H
 
 #include "graph.h"
+#include "thread_pool.h"
+#include "checkpoint.h"
+#include "stats.h"
+#include "neighbor_scan.h"
+#include "initial_coloring.h"
 #include <unordered_map>
 #include <unordered_set>
-#include <map> // For embind-friendly map bindings
 #include <algorithm>
 #include <iostream>
 #include <random>
 #include <functional>
 #include <vector>
 #include <memory>
-#include <emscripten/bind.h>
+#include <climits>
+#include <array>
+#include <span>
+#include <string>
 
 struct Color
 {
@@ -19,7 +26,9 @@ struct Color
     int r, g, b;
 };
 
-typedef std::map<std::shared_ptr<GraphNode>, Color> ColoringMap;
+// Color index of every vertex, addressed by VertexId. RGB values are resolved
+// through ColorPalette only when a coloring is exported.
+typedef std::vector<int> ColoringArray;
 
 class ColorPalette
 {
@@ -29,7 +38,7 @@ public:
     {
         for (int i = 0; i < presetCount_; ++i)
         {
-            presetColors_.push_back(generateColor(i));
+            pushColor(generateColor(i));
         }
     }
 
@@ -40,7 +49,14 @@ public:
 
     void addColor()
     {
-        presetColors_.push_back(generateColor(presetCount_++));
+        pushColor(generateColor(presetCount_++));
+    }
+
+    void removeLastColor()
+    {
+        --presetCount_;
+        presetColors_.pop_back();
+        packedRGB_.resize(packedRGB_.size() - 3);
     }
 
     int size() const
@@ -50,6 +66,9 @@ public:
 
     const std::vector<Color> &getColors() const { return presetColors_; }
 
+    // r, g, b bytes of every color back to back, for export as a single Uint8Array
+    const std::vector<std::uint8_t> &packedRGB() const { return packedRGB_; }
+
     auto begin() const { return presetColors_.begin(); }
     auto end() const { return presetColors_.end(); }
 
@@ -62,32 +81,114 @@ private:
         return Color{i, (i * 97) % 256, (i * 57) % 256, (i * 37) % 256};
     }
 
+    void pushColor(const Color &color)
+    {
+        presetColors_.push_back(color);
+        packedRGB_.insert(packedRGB_.end(), {static_cast<std::uint8_t>(color.r), static_cast<std::uint8_t>(color.g), static_cast<std::uint8_t>(color.b)});
+    }
+
     int presetCount_;
     std::vector<Color> presetColors_;
+    std::vector<std::uint8_t> packedRGB_;
 };
 
-// Same rationale as above: switch to std::map for embind compatibility.
-typedef std::map<int, int> UsedColorsMap;
+// Number of vertices using each color, addressed by color index.
+typedef std::vector<int> UsedColorsArray;
+
+// Conflicted vertices bucketed by (same-colored neighbor count, color). The top
+// non-empty conflict level is tracked incrementally; within it the color with the
+// lowest usage wins, so selection costs O(palette) instead of O(V + E).
+class ConflictBuckets
+{
+public:
+    void reset(std::size_t numVertices, int maxConflicts, int numColors);
+    // Move v to the bucket for (conflicts, color); conflicts == 0 removes it.
+    void set(VertexId v, int conflicts, int color);
+    // Most conflicting vertex, ties broken by least used color; -1 when conflict-free.
+    int select(const UsedColorsArray &usedColors) const
+    {
+        return selectWhere(usedColors, [](VertexId)
+                           { return false; });
+    }
+
+    // Same as select() but passes over vertices for which skip(v) holds, walking down
+    // the conflict levels until a vertex qualifies.
+    template <typename Skip>
+    int selectWhere(const UsedColorsArray &usedColors, Skip skip) const
+    {
+        for (int level = topLevel_; level > 0; --level)
+        {
+            const int *heads = heads_.data() + static_cast<std::size_t>(level) * numColors_;
+            int bestV = -1;
+            int bestColorUse = INT_MAX; // we prefer the least-used color
+            for (int c = 0; c < numColors_; ++c)
+            {
+                if (heads[c] < 0 || usedColors[c] >= bestColorUse)
+                    continue;
+                for (int v = heads[c]; v >= 0; v = next_[v])
+                {
+                    if (!skip(static_cast<VertexId>(v)))
+                    {
+                        bestColorUse = usedColors[c];
+                        bestV = v;
+                        break;
+                    }
+                }
+            }
+            if (bestV >= 0)
+                return bestV;
+        }
+        return -1;
+    }
+
+    // Highest conflict count of any vertex in the queue.
+    int topLevel() const { return topLevel_; }
+
+    // Shrink to numColors - 1 colors; the last color must have no queued vertex.
+    void dropLastColor();
+
+    // Bucket chain order decides ties in select(); a checkpoint keeps it so a resumed search
+    // picks the same vertices. restore() expects the buckets already rebuilt from the same coloring.
+    void save(CheckpointWriter &out) const;
+    void restore(CheckpointReader &in);
+
+    // Bytes held by the queue's arrays, what a copy of it moves
+    std::size_t footprintBytes() const
+    {
+        return (heads_.size() + levelSize_.size() + next_.size() + prev_.size() + slot_.size()) * sizeof(int);
+    }
+
+private:
+    void unlink(VertexId v);
+
+    int numColors_ = 0;
+    int topLevel_ = 0;
+    std::vector<int> heads_;     // (level * numColors_ + color) -> first vertex, -1 if empty
+    std::vector<int> levelSize_; // vertices per conflict level
+    std::vector<int> next_;
+    std::vector<int> prev_;
+    std::vector<int> slot_; // bucket of each vertex, -1 when conflict-free
+};
 
 struct StepResult
 {
-    std::shared_ptr<GraphNode> node;
+    int node; // vertex id, -1 when no vertex was touched
     Color color;
     int conflicts;
     bool continueIteration;
 
     StepResult(int conflicts = 0)
-        : node(nullptr), color(), conflicts(conflicts), continueIteration(false)
+        : node(-1), color(), conflicts(conflicts), continueIteration(false)
     {
     }
 
     StepResult(bool continueIter)
-        : node(nullptr), color(), conflicts(0), continueIteration(continueIter)
+        : node(-1), color(), conflicts(0), continueIteration(continueIter)
     {
     }
 
-    StepResult(std::shared_ptr<GraphNode> n, Color c, int conf, bool cont)
-        : node(std::move(n)), color(c), conflicts(conf), continueIteration(cont)
+    StepResult(int n, Color c, int conf, bool cont)
+        : node(n), color(c), conflicts(conf), continueIteration(cont)
     {
     }
 };
@@ -97,34 +198,54 @@ struct StateNode
 public:
     int computeH() const
     {
-        auto it = usedColors.find(color.index);
-        int colorUsage = (it != usedColors.end()) ? it->second : 0;
+        int colorUsage = (color >= 0 && color < (int)usedColors.size()) ? usedColors[color] : 0;
         return conflicts * 100 - colorUsage;
     }
 
-    void forward(Color c, std::shared_ptr<GraphNode> node)
+    void forward(int c, VertexId node)
     {
-        // Efficiently update conflicts using oldInc/newInc trick
-        int oldColorIdx = coloring.at(node).index;
+        // Efficiently update conflicts using oldInc/newInc trick, touching only node's neighbors
+        int oldColorIdx = coloring[node];
+        // Recoloring to the same color is a no-op; the counting below assumes the colors differ
+        if (c == oldColorIdx)
+            return;
         int oldInc = 0, newInc = 0;
-        for (const auto &nbr : node->getNeighbors())
+        std::span<const VertexId> neighbors = graph->neighbors(node);
+        // Self-loops conflict under every color, so they never enter the per-vertex counters
+        if (!neighborColors.empty())
         {
-            auto it = coloring.find(nbr);
-            if (it != coloring.end())
+            const std::size_t stride = palette.size();
+            for (VertexId nbr : neighbors)
             {
-                if (it->second.index == oldColorIdx)
-                    oldInc++;
-                if (it->second.index == c.index)
-                    newInc++;
+                if (nbr == node)
+                    continue;
+                int *row = neighborColors.data() + nbr * stride;
+                row[oldColorIdx]--;
+                row[c]++;
             }
         }
+        // Only neighbors on the old or the new color change their conflict count
+        visitNeighborsWithColors(neighbors, coloring.data(), oldColorIdx, c, node, [&](VertexId nbr, int nbrColor)
+                                 {
+            if (nbrColor == oldColorIdx)
+            {
+                oldInc++;
+                conflictQueue.set(nbr, --nodeConflicts[nbr], nbrColor);
+            }
+            else
+            {
+                newInc++;
+                conflictQueue.set(nbr, ++nodeConflicts[nbr], nbrColor);
+            } });
+        nodeConflicts[node] = newInc;
+        conflictQueue.set(node, nodeConflicts[node], c);
         // Update coloring and usedColors
         coloring[node] = c;
         usedColors[oldColorIdx]--;
-        usedColors[c.index]++;
+        usedColors[c]++;
         // Update conflicts
         int newConflicts = conflicts - oldInc + newInc;
-        this->node = node;
+        this->node = static_cast<int>(node);
         color = c;
         conflicts = newConflicts;
         continueIteration = true;
@@ -135,121 +256,217 @@ public:
           palette(0), // Initialize with 0 preset colors
           coloring(),
           usedColors(),
-          node(nullptr),
-          color(),
+          node(-1),
+          color(0),
           conflicts(0),
           continueIteration(false)
     {
     }
 
-    StateNode(std::shared_ptr<Graph> g, ColorPalette p, ColoringMap c, int conflicts, UsedColorsMap used)
+    StateNode(std::shared_ptr<Graph> g, ColorPalette p, ColoringArray c, int conflicts, UsedColorsArray used)
         : graph(std::move(g)),
           palette(std::move(p)),
           coloring(std::move(c)),
           usedColors(std::move(used)),
-          node(nullptr),
-          color(),
+          node(-1),
+          color(0),
           conflicts(conflicts),
           continueIteration(false)
     {
+        rebuildConflictIndex();
     }
 
-    // default constructor, destructor ok
-    StateNode(StateNode &&other) noexcept
-        : graph(std::move(other.graph)),
-          palette(std::move(other.palette)),
-          coloring(std::move(other.coloring)),
-          usedColors(std::move(other.usedColors)),
-          node(std::move(other.node)),
-          color(other.color),
-          conflicts(other.conflicts),
-          continueIteration(other.continueIteration) {}
-
-    StateNode(const StateNode &other)
-        : graph(other.graph),
-          palette(other.palette),
-          coloring(other.coloring),
-          usedColors(other.usedColors),
-          node(other.node),
-          color(other.color),
-          conflicts(other.conflicts),
-          continueIteration(other.continueIteration) {}
-
-    StateNode &operator=(const StateNode &other)
+    // Recompute per-vertex conflict counters, the bucket queue and the conflict total from coloring.
+    void rebuildConflictIndex();
+
+    // Allocate and fill the V x palette neighbor color table; forward() keeps it current from then on.
+    void enableNeighborColorTable();
+
+    // Retire color: its vertices move one by one to their least conflicting remaining color, the
+    // last color is relabeled to take its index and the palette shrinks by one. Everything goes
+    // through forward(), so conflicts, usage and the indexes stay current without a rebuild.
+    void removeColor(int color);
+
+    // Neighbors of v per color, indexed by color. Only valid once the table is enabled.
+    const int *neighborColorRow(VertexId v) const
     {
-        if (this != &other)
-        {
-            graph = other.graph;
-            palette = other.palette;
-            coloring = other.coloring;
-            usedColors = other.usedColors;
-            node = other.node;
-            color = other.color;
-            conflicts = other.conflicts;
-            continueIteration = other.continueIteration;
-        }
-        return *this;
+        return neighborColors.data() + static_cast<std::size_t>(v) * palette.size();
     }
 
-    StateNode &operator=(StateNode &&other) noexcept
+    // Bytes a copy of this state moves (the graph is shared, not copied)
+    std::size_t footprintBytes() const
     {
-        if (this != &other)
-        {
-            graph = std::move(other.graph);
-            palette = std::move(other.palette);
-            coloring = std::move(other.coloring);
-            usedColors = std::move(other.usedColors);
-            node = std::move(other.node);
-            color = other.color;
-            conflicts = other.conflicts;
-            continueIteration = other.continueIteration;
-        }
-        return *this;
+        return (coloring.size() + usedColors.size() + nodeConflicts.size() + neighborColors.size()) * sizeof(int) + conflictQueue.footprintBytes();
     }
 
+    // Every member is a flat array or a scalar, so copies are plain memcpy-sized vector copies.
+    StateNode(StateNode &&other) noexcept = default;
+    StateNode(const StateNode &other) = default;
+    StateNode &operator=(const StateNode &other) = default;
+    StateNode &operator=(StateNode &&other) noexcept = default;
+
     std::shared_ptr<Graph> graph;
     ColorPalette palette;
-    ColoringMap coloring;
-    UsedColorsMap usedColors;
+    ColoringArray coloring;
+    UsedColorsArray usedColors;
+    std::vector<int> nodeConflicts; // same-colored neighbors of every vertex, self-loops excluded
+    std::vector<int> neighborColors; // optional, neighborColors[v * palette.size() + c] = neighbors of v colored c
+    ConflictBuckets conflictQueue;
     // Flattened former StepResult data:
-    std::shared_ptr<GraphNode> node; // last modified / selected node
-    Color color;                     // color applied in last step
-    int conflicts;                   // current number of conflicts
-    bool continueIteration;          // whether algorithm can continue
+    int node;               // last modified / selected vertex, -1 if none
+    int color;              // color index applied in last step
+    int conflicts;          // current number of conflicts
+    bool continueIteration; // whether algorithm can continue
+};
+
+// Vertices with at least one conflict in a dense, unordered list, so one can be drawn uniformly
+// at random. List order decides which vertex a draw or a scan picks, so checkpoints keep it.
+class ConflictingVertices
+{
+public:
+    // Rebuild from the state's conflict counts; capacity for every vertex is reserved up front,
+    // so updates never allocate
+    void reset(const StateNode &state);
+    // Re-file v after its conflict count changed
+    void update(const StateNode &state, VertexId v);
+    // Re-file v and its neighbors, every vertex StateNode::forward(_, v) can change
+    void updateAround(const StateNode &state, VertexId v);
+    // Replace the order with a saved one; false unless it lists exactly the current vertices
+    bool restoreOrder(std::span<const VertexId> order);
+
+    std::span<const VertexId> vertices() const { return list_; }
+    std::size_t size() const { return list_.size(); }
+    bool empty() const { return list_.empty(); }
+    template <typename Rng>
+    VertexId sample(Rng &rng) const
+    {
+        return list_[std::uniform_int_distribution<std::size_t>(0, list_.size() - 1)(rng)];
+    }
+
+private:
+    std::vector<VertexId> list_;
+    std::vector<int> pos_; // index in list_, -1 if absent
+};
+
+// One recolor of the reported state, as recorded in an iterator's change log.
+struct VertexChange
+{
+    VertexId vertex;
+    int oldColor;
+    int newColor;
+    int conflictsAfter; // total conflicts once the change is applied
+};
+
+// Kempe chain interchange: the connected component of v in the subgraph of its color a and a
+// target color b, joined by a-b edges, with a and b swapped throughout. Edges inside one color
+// are conflicts rather than chain links, so in a proper coloring this is the classic Kempe chain
+// and the swap keeps it proper; otherwise the swap resolves every conflict crossing the chain
+// boundary and never creates one.
+struct KempeMove
+{
+    int conflictDelta = 0; // change in total conflicts, never positive
+    int fromCount = 0;     // chain vertices on v's color, which move to the target color
+    int toCount = 0;       // chain vertices on the target color, which move to v's
+};
+
+// Incremental BFS over dense per-vertex stamps; the buffers are reused from move to move.
+class KempeChain
+{
+public:
+    // Collect the chain of v for target color b and score the swap; state is not modified. With b
+    // equal to v's color the chain is empty and the move scores zero
+    KempeMove evaluate(const StateNode &state, VertexId v, int b);
+    // Swap the chain last evaluated on state, one forward() per vertex, logging each change
+    void apply(StateNode &state, std::vector<VertexChange> *changeLog) const;
+    std::size_t size() const { return chain_.size(); }
+    // Size the buffers for a graph up front, so that no evaluate() on it allocates
+    void reserve(std::size_t numVertices);
+
+private:
+    bool inChain(VertexId v) const { return stamp_[v] == epoch_; }
+
+    std::vector<std::uint32_t> stamp_;
+    std::uint32_t epoch_ = 0;
+    std::vector<VertexId> chain_; // BFS order; doubles as the queue
+    int fromColor_ = 0;
+    int toColor_ = 0;
+};
+
+// Move types beyond single-vertex recoloring, for hill climbing and simulated annealing
+struct NeighborhoodOptions
+{
+    // Kempe chain interchanges. Hill climbing tries every target color for the selected vertex once
+    // no recolor improves; annealing proposes one instead of a recolor with probability kempeRate.
+    bool kempeChains = false;
+    double kempeRate = 0.2;
+};
+
+struct RepairResult
+{
+    int recolorings = 0;
+    // False when the budget ran out with improvable vertices still queued
+    bool fixpoint = true;
 };
 
 struct AlgorithmIterator
 {
     virtual ~AlgorithmIterator() = default;
-    // Step one iteration, returns tuple (node, color, continue)
-    virtual StateNode step() = 0; // now returns the whole (copied) state
+    // Step one iteration, returns whether the algorithm can continue
+    virtual bool step() = 0;
     // Step until done
     virtual void runToEnd()
     {
-        while (step().continueIteration)
+        while (step())
             ;
     }
     // Get current coloring
-    virtual const ColoringMap &getColoring() const = 0;
+    virtual const ColoringArray &getColoring() const = 0;
     // Get current state
     virtual const StateNode &getState() const = 0;
     // Expose current iteration counter
     virtual int currentIteration() const = 0;
+    // Conflicts of the reported state, without materializing it
+    virtual int currentConflicts() const = 0;
+    // Hand the reported state to the caller, leaving the iterator unusable; iterators that keep
+    // it as a single member move it out, the rest copy it
+    virtual StateNode releaseState() { return getState(); }
+    // Append every recolor of the reported state to log from now on; nullptr stops recording
+    virtual void setChangeLog(std::vector<VertexChange> *log) { changeLog_ = log; }
+    // Run repairConflicts() on the reported state, logging its recolors, and rebuild whatever the
+    // iterator derives from that state so the search can carry on from the repaired coloring
+    virtual RepairResult repair() = 0;
+    // Name initializeAlgorithm() knows this iterator by, and its iteration budget
+    virtual const char *name() const = 0;
+    virtual int maxIterations() const = 0;
+    // Everything beyond the graph, palette and reported coloring needed to resume exactly where
+    // the search stopped; restoreState() runs on an iterator freshly built from that state
+    virtual void saveState(CheckpointWriter &out) const = 0;
+    virtual void restoreState(CheckpointReader &in) = 0;
+    // Phase timers and counters accumulated by step() since construction (zeros unless built
+    // with GRAPH_COLORING_STATS)
+    virtual SearchStats searchStats() const { return searchStats_; }
+
+protected:
+    std::vector<VertexChange> *changeLog_ = nullptr;
+    SearchStats searchStats_;
 };
 
 class HillClimbingColoringIterator : public AlgorithmIterator
 {
 public:
-    HillClimbingColoringIterator(std::unique_ptr<StateNode> initialState, int maxIterations, std::mt19937 rng = std::mt19937(std::random_device{}()));
-    StateNode step() override;
-    void runToEnd() override
-    {
-        while (step().continueIteration)
-            ;
-    }
-    const ColoringMap &getColoring() const override;
+    HillClimbingColoringIterator(std::unique_ptr<StateNode> initialState, int maxIterations, std::mt19937 rng = std::mt19937(std::random_device{}()), const NeighborhoodOptions &neighborhood = NeighborhoodOptions());
+    bool step() override;
+    const ColoringArray &getColoring() const override;
     const StateNode &getState() const override;
+    StateNode releaseState() override { return std::move(current_); }
     int currentIteration() const override { return iteration_; }
+    int currentConflicts() const override { return current_.conflicts; }
+    const char *name() const override { return "hill_climbing"; }
+    int maxIterations() const override { return maxIterations_; }
+    void saveState(CheckpointWriter &out) const override;
+    void restoreState(CheckpointReader &in) override;
+    RepairResult repair() override;
+    const NeighborhoodOptions &neighborhood() const { return neighborhood_; }
 
 private:
     StateNode current_;
@@ -258,49 +475,312 @@ private:
     bool finished_;
     std::mt19937 rng_;
     bool greedyDone_;
+    NeighborhoodOptions neighborhood_;
+    KempeChain kempe_;
 };
 
-class SimulatedAnnealingColoringIterator : public AlgorithmIterator
+// Metropolis acceptance of integer uphill H deltas at one temperature. accept() compares a
+// uniform 32-bit draw against a precomputed 2^32 * exp(-delta / T), so no exp() per move.
+class AcceptanceTable
 {
 public:
-    SimulatedAnnealingColoringIterator(std::unique_ptr<StateNode> initialState, int maxIterations, std::mt19937 rng = std::mt19937(std::random_device{}()));
-    StateNode step() override;
-    void runToEnd() override
+    // Deltas above maxDelta never occur; entries past the point where exp() drops below 2^-32 are omitted
+    void setTemperature(double temperature, int maxDelta);
+    double temperature() const { return temperature_; }
+    bool accept(int delta, std::uint32_t draw) const
     {
-        while (step().continueIteration)
-            ;
+        return delta <= 0 || (static_cast<std::size_t>(delta) < thresholds_.size() && draw < thresholds_[delta]);
     }
-    const ColoringMap &getColoring() const override;
+
+private:
+    double temperature_ = 0.0;
+    std::vector<std::uint32_t> thresholds_;
+};
+
+enum class CoolingSchedule
+{
+    Geometric,   // T0 * (Tf / T0)^(t / budget)
+    Linear,      // T0 + (Tf - T0) * t / budget
+    Logarithmic, // T0 / (1 + c * ln(1 + t)), c chosen so the budget ends at Tf
+    Adaptive,    // geometric, scaled up (reheated) while too few uphill moves are accepted
+};
+
+// "geometric", "linear", "logarithmic" or "adaptive"
+CoolingSchedule parseCoolingSchedule(const std::string &name);
+// Inverse of parseCoolingSchedule
+const char *coolingScheduleName(CoolingSchedule schedule);
+
+// Temperatures are in H units, where one conflict is worth 100. Every schedule runs from
+// initialTemperature to finalTemperature over the iteration budget.
+struct AnnealingOptions
+{
+    CoolingSchedule schedule = CoolingSchedule::Geometric;
+    double initialTemperature = 100.0;
+    double finalTemperature = 0.5;
+    // Adaptive: the acceptance rate of uphill moves each stage aims for, and the reheat/cool-back step
+    double targetAcceptance = 0.05;
+    double reheatFactor = 1.5;
+};
+
+class SimulatedAnnealingColoringIterator : public AlgorithmIterator
+{
+public:
+    SimulatedAnnealingColoringIterator(std::unique_ptr<StateNode> initialState, int maxIterations, std::mt19937 rng = std::mt19937(std::random_device{}()), const AnnealingOptions &options = AnnealingOptions(), const NeighborhoodOptions &neighborhood = NeighborhoodOptions());
+    bool step() override;
+    const ColoringArray &getColoring() const override;
     const StateNode &getState() const override;
+    StateNode releaseState() override { return std::move(current_); }
     int currentIteration() const override { return iteration_; }
+    int currentConflicts() const override { return current_.conflicts; }
+    const char *name() const override { return "simulated_annealing"; }
+    int maxIterations() const override { return maxIterations_; }
+    void saveState(CheckpointWriter &out) const override;
+    void restoreState(CheckpointReader &in) override;
+    RepairResult repair() override;
+    double temperature() const { return acceptance_.temperature(); }
+    const AnnealingOptions &annealing() const { return options_; }
+    const NeighborhoodOptions &neighborhood() const { return neighborhood_; }
 
 private:
+    // The temperature is held for budget / kStages iterations at a time, so the table is rebuilt rarely
+    static constexpr int kStages = 1000;
+
+    // Temperature and acceptance table for the stage starting at iteration t (0-based)
+    void beginStage(int t);
+
     StateNode current_;
     int maxIterations_;
     int iteration_;
     bool finished_;
     std::mt19937 rng_;
     bool greedyDone_;
-    double schedule_(int t);
+    AnnealingOptions options_;
+    AcceptanceTable acceptance_;
+    int maxDelta_;
+    int stageLength_;
+    // Adaptive: current reheat multiplier and the uphill moves seen this stage
+    double reheat_;
+    int uphillProposed_;
+    int uphillAccepted_;
+    NeighborhoodOptions neighborhood_;
+    KempeChain kempe_;
+};
+
+// Move counters of one rung of a parallel tempering temperature ladder.
+struct ReplicaStats
+{
+    double temperature = 0.0;
+    long long proposed = 0;
+    long long accepted = 0;
+    // Exchanges attempted with / accepted from the next hotter rung
+    long long swapsProposed = 0;
+    long long swapsAccepted = 0;
+};
+
+// Replica exchange annealing: one chain per rung of a geometric temperature ladder. Every step
+// each chain makes kRoundMoves Metropolis moves at its rung's temperature, each recoloring a
+// conflicting vertex drawn uniformly at random, chains running in parallel. Then alternating
+// pairs of neighboring rungs exchange chains with probability
+// min(1, exp((1/Ti - 1/Tj) * (Ei - Ej))), E = 100 * conflicts. The reported state is the chain
+// with the fewest conflicts; iterations count moves per chain.
+class ParallelTemperingColoringIterator : public AlgorithmIterator
+{
+public:
+    // numReplicas == 0 uses max(8, threads); numThreads == 0 uses every hardware thread
+    ParallelTemperingColoringIterator(std::unique_ptr<StateNode> initialState, int maxIterations, std::mt19937 rng = std::mt19937(std::random_device{}()), unsigned numThreads = 0, int numReplicas = 0);
+    bool step() override;
+    void setChangeLog(std::vector<VertexChange> *log) override;
+    const ColoringArray &getColoring() const override;
+    const StateNode &getState() const override;
+    int currentIteration() const override { return iteration_; }
+    int currentConflicts() const override { return replicas_[best_].conflicts; }
+    const char *name() const override { return "parallel_tempering"; }
+    int maxIterations() const override { return maxIterations_; }
+    void saveState(CheckpointWriter &out) const override;
+    void restoreState(CheckpointReader &in) override;
+    RepairResult repair() override;
+    // One entry per rung, coldest first
+    const std::vector<ReplicaStats> &replicaStats() const { return stats_; }
+    SearchStats searchStats() const override;
+
+private:
+    static constexpr int kRoundMoves = 64;
+    static constexpr double kMinTemperature = 5.0;
+    static constexpr double kMaxTemperature = 200.0;
+
+    // Log the recolors turning the previously reported chain into replicas_[best_]
+    void recordBestChanges();
+
+    std::vector<StateNode> replicas_;
+    std::vector<std::mt19937> replicaRngs_; // one stream per chain, so results ignore thread count
+    std::vector<ConflictingVertices> conflicting_; // per chain, the vertices its moves are drawn from
+    std::vector<std::size_t> replicaAt_;    // chain currently on each rung
+    std::vector<ReplicaStats> stats_;
+    std::vector<AcceptanceTable> acceptance_; // per rung; the ladder is fixed, so built once
+    std::vector<SearchStats> workerStats_;    // per pool worker, folded in by searchStats()
+    std::size_t best_;
+    int maxIterations_;
+    int iteration_;
+    int round_;
+    bool finished_;
+    std::mt19937 rng_;
+    ThreadPool pool_;
+    ColoringArray reported_; // coloring last written to the change log
+};
+
+// TabuCol (Hertz & de Werra, with Galinier & Hao's tenure): every step makes the best recolor of a
+// conflicting vertex, even a worsening one. The color a vertex leaves is tabu for it for a tenure
+// that grows with the number of conflicting vertices, unless the move would beat the best conflict
+// count seen so far (aspiration). Moves are scored from the neighbor color table, and the best
+// coloring found is restored when the search stops.
+class TabuColoringIterator : public AlgorithmIterator
+{
+public:
+    TabuColoringIterator(std::unique_ptr<StateNode> initialState, int maxIterations, std::mt19937 rng = std::mt19937(std::random_device{}()));
+    bool step() override;
+    const ColoringArray &getColoring() const override;
+    const StateNode &getState() const override;
+    StateNode releaseState() override { return std::move(current_); }
+    int currentIteration() const override { return iteration_; }
+    int currentConflicts() const override { return current_.conflicts; }
+    const char *name() const override { return "tabu"; }
+    int maxIterations() const override { return maxIterations_; }
+    void saveState(CheckpointWriter &out) const override;
+    void restoreState(CheckpointReader &in) override;
+    RepairResult repair() override;
+
+private:
+    // tenure = U[0, kTenureRandom) + kTenureFactor * (number of conflicting vertices)
+    static constexpr int kTenureRandom = 10;
+    static constexpr double kTenureFactor = 0.6;
+
+    void applyMove(VertexId v, int color);
+    void finish();
+
+    StateNode current_;
+    int maxIterations_;
+    int iteration_;
+    bool finished_;
+    std::mt19937 rng_;
+    // [v * palette + c]: first iteration at which v may take color c again
+    std::vector<int> tabuUntil_;
+    ConflictingVertices conflicting_;
+    // The best coloring is kept as the (vertex, previous color) moves made since reaching it;
+    // once that list outgrows the graph it is replaced by a full snapshot
+    int bestConflicts_;
+    std::vector<std::pair<VertexId, int>> sinceBest_;
+    ColoringArray bestColoring_;
+    bool bestSnapshot_;
+};
+
+// One recolor applied on top of a beam member's base state.
+struct BeamMove
+{
+    VertexId vertex;
+    int from;
+    int to;
+};
+
+// A beam member is a shared, immutable base state plus the short list of moves made since.
+// The moves live in the iterator's move arena, not in the member.
+struct BeamMember
+{
+    std::shared_ptr<const StateNode> base;
+    std::span<const BeamMove> moves;
+    int node;
+    int color;
+    int conflicts;
+    int h;
+};
+
+// A scored expansion of a beam member; only the survivors of top-k selection are built.
+struct BeamCandidate
+{
+    int parent;
+    VertexId vertex;
+    int color;
+    int conflicts;
+    int h;
+};
+
+// Strict total order used for top-k selection: lower H first, then a fixed tie-break so the
+// chosen set never depends on how candidates were split across threads.
+inline bool beamCandidateLess(const BeamCandidate &a, const BeamCandidate &b)
+{
+    if (a.h != b.h)
+        return a.h < b.h;
+    if (a.conflicts != b.conflicts)
+        return a.conflicts < b.conflicts;
+    if (a.parent != b.parent)
+        return a.parent < b.parent;
+    return a.color < b.color;
+}
+
+// Scratch kept between kLeast() calls
+struct KLeastBuffers
+{
+    std::vector<std::pair<std::size_t, std::size_t>> winners; // per worker: slice start, kept count
+    std::vector<BeamCandidate> merged;
 };
 
 class BeamColoringIterator : public AlgorithmIterator
 {
 public:
-    BeamColoringIterator(std::unique_ptr<StateNode> initialState, int maxIterations, std::mt19937 rng = std::mt19937(std::random_device{}()));
-    StateNode step() override;
-    void runToEnd() override
-    {
-        while (step().continueIteration)
-            ;
-    }
-    const ColoringMap &getColoring() const override;
+    // numThreads == 0 uses every hardware thread for member expansion and top-k selection
+    BeamColoringIterator(std::unique_ptr<StateNode> initialState, int maxIterations, std::mt19937 rng = std::mt19937(std::random_device{}()), unsigned numThreads = 0);
+    bool step() override;
+    void setChangeLog(std::vector<VertexChange> *log) override;
+    const ColoringArray &getColoring() const override;
     const StateNode &getState() const override;
     int currentIteration() const override { return iteration_; }
+    int currentConflicts() const override { return beam_[0].conflicts; }
+    const char *name() const override { return "beam"; }
+    int maxIterations() const override { return maxIterations_; }
+    void saveState(CheckpointWriter &out) const override;
+    void restoreState(CheckpointReader &in) override;
+    RepairResult repair() override;
+    SearchStats searchStats() const override;
 
 private:
-    std::vector<StateNode> beam_;
-    std::vector<StateNode> candidates_;
+    // Longest move list a member carries before it is folded into a fresh base state
+    static constexpr std::size_t kMaxMoves = 64;
+
+    // Per-thread scratch space, restored to its neutral value after every expansion
+    struct Scratch
+    {
+        std::vector<int> overlayColor; // member color of vertices moved since the base, -1 otherwise
+        std::vector<char> touched;     // vertices whose conflict count differs from the base
+        std::vector<VertexId> touchedList;
+        UsedColorsArray usage;
+        std::vector<int> neighborColorCount;
+        std::vector<int> colorOrder; // shuffled per beam member to pick the k_ candidate colors
+        SearchStats stats;           // this worker's share, folded in by searchStats()
+    };
+
+    // Log the recolors turning the previously reported member into beam_[0]
+    void recordBestChanges();
+    // Writes up to k_ candidates to out and returns how many
+    int expandMember(int memberIndex, Scratch &scratch, std::uint32_t seed, BeamCandidate *out) const;
+    // Overwrite out with member's base plus its moves; out's buffers are reused
+    void materialize(const BeamMember &member, StateNode &out) const;
+    // A pooled base nobody else references. The constructor fills the pool for the worst case,
+    // so the fallback to a new base never runs in practice
+    std::shared_ptr<StateNode> acquireBase();
+    // kMaxMoves slots of the arena half being written this step, for member i
+    BeamMove *moveSlot(std::size_t generation, std::size_t member) { return moveArena_[generation % 2].data() + member * kMaxMoves; }
+
+    // Every per-step container below is sized once and reused, so steady-state steps do not
+    // allocate. Move lists alternate between the two arena halves: children are written to
+    // one while their parents are still read from the other.
+    std::vector<BeamMember> beam_;
+    std::vector<BeamMember> nextBeam_;
+    std::array<std::vector<BeamMove>, 2> moveArena_;
+    std::vector<std::shared_ptr<StateNode>> basePool_;
+    std::vector<std::shared_ptr<const StateNode>> rebased_; // per parent, its folded base this step
+    KLeastBuffers kLeastBuffers_;
+    std::vector<BeamCandidate> candidates_;
+    std::vector<int> candidateCounts_;
+    std::vector<std::uint32_t> memberSeeds_; // drawn serially from rng_ so results ignore thread count
     int k_;
     int paletteSize_;
     int maxIterations_;
@@ -308,11 +788,39 @@ private:
     bool finished_;
     std::mt19937 rng_;
     bool greedyDone_;
+    ThreadPool pool_;
+    std::vector<Scratch> scratch_;
+    mutable StateNode best_; // materialized beam_[0], rebuilt lazily by getState()
+    mutable bool bestDirty_;
+    // Coloring last written to the change log, and the base + moves it corresponds to
+    ColoringArray reported_;
+    std::shared_ptr<const StateNode> reportedBase_;
+    std::vector<BeamMove> reportedMoves_;
 };
 
-std::vector<StateNode> kLeast(std::vector<StateNode> &arr, int k);
-
-int computeConflicts(const Graph &graph, const ColoringMap &coloring);
-void greedyRemoveConflicts(StateNode &state);
+// The k smallest candidates under beamCandidateLess, in ascending order, written to
+// buffers.merged. Each pool worker selects from its own slice and the per-slice winners
+// are merged; the buffers keep their capacity between calls.
+void kLeast(std::vector<BeamCandidate> &arr, int k, ThreadPool &pool, KLeastBuffers &buffers);
+
+// Initial coloring built as options ask: random over a maxDegree + 1 palette, or a constructive
+// k-coloring over a palette of exactly the colors it uses (k - 1 with oneColorFewer)
+StateNode initialStateNode(std::shared_ptr<Graph> graph, std::mt19937 &rng, const InitialColoringOptions &options = InitialColoringOptions());
+StateNode initialStateNode(const RandomGraphOptions &options, std::mt19937 &rng, const InitialColoringOptions &initialColoring = InitialColoringOptions());
+
+// Construct an iterator by name: "hill_climbing", "simulated_annealing", "parallel_tempering", "tabu" or "beam".
+// numThreads bounds the worker threads of iterators that parallelize (0 = all hardware threads);
+// annealing only applies to simulated annealing, neighborhood to hill climbing and simulated annealing.
+std::unique_ptr<AlgorithmIterator> initializeAlgorithm(std::unique_ptr<StateNode> initialState, const std::string &algorithmName, int iterations, std::mt19937 rng, unsigned numThreads = 0, const AnnealingOptions &annealing = AnnealingOptions(), const NeighborhoodOptions &neighborhood = NeighborhoodOptions());
+
+int computeConflicts(const Graph &graph, const ColoringArray &coloring);
+// State over graph and palette with the given coloring; usage and conflicts are computed
+StateNode stateFromColoring(std::shared_ptr<Graph> graph, const ColorPalette &palette, ColoringArray coloring);
+
+// Post-pass over a finished search: a worklist of conflicting vertices, each recolored to its
+// least conflicting color in O(deg + palette) through StateNode::forward, so conflicts, usage
+// and the conflict index stay current throughout. Neighbors a move can affect are requeued; runs
+// until no conflicting vertex can improve, or after budget recolorings (negative = unlimited).
+RepairResult repairConflicts(StateNode &state, int budget = -1);
 
 #endif // ALGORITHM_H
\ No newline at end of file
@@ -0,0 +1,250 @@
+#include "background_solver.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <stdexcept>
+
+namespace
+{
+std::atomic_ref<std::int32_t> wordRef(std::span<std::int32_t> words, ProgressWord word)
+{
+    return std::atomic_ref<std::int32_t>(words[word]);
+}
+}
+
+ProgressChannel::ProgressChannel(std::size_t capacityWords)
+    : words_(kProgressHeaderWords + std::bit_ceil(std::max<std::size_t>(capacityWords, 64)), 0)
+{
+    words_[kCapacity] = static_cast<std::int32_t>(capacity());
+}
+
+std::int32_t ProgressChannel::load(ProgressWord word) const
+{
+    return wordRef(const_cast<std::vector<std::int32_t> &>(words_), word).load(std::memory_order_acquire);
+}
+
+void ProgressChannel::store(ProgressWord word, std::int32_t value)
+{
+    wordRef(words_, word).store(value, std::memory_order_release);
+}
+
+void ProgressChannel::notify(ProgressWord word)
+{
+    wordRef(words_, word).notify_all();
+}
+
+bool ProgressChannel::tryPublish(int iteration, int conflicts, int bestConflicts, std::span<const int> records)
+{
+    const std::size_t length = kMessageHeaderWords + records.size();
+    if (length > capacity() / 2)
+        throw std::length_error("Progress message larger than half the ring");
+    const std::uint32_t write = static_cast<std::uint32_t>(words_[kWriteIndex]); // only this thread writes it
+    const std::uint32_t read = static_cast<std::uint32_t>(load(kReadIndex));
+    const std::uint32_t slot = write & static_cast<std::uint32_t>(capacity() - 1);
+    const std::size_t tail = capacity() - slot;
+    const std::size_t needed = length <= tail ? length : tail + length;
+    if ((write - read) + needed > capacity())
+        return false;
+
+    std::int32_t *at = ring() + slot;
+    std::uint32_t next = write;
+    if (length > tail)
+    {
+        *at = kWrapMarker;
+        at = ring();
+        next += static_cast<std::uint32_t>(tail);
+    }
+    at[0] = static_cast<std::int32_t>(length);
+    at[1] = iteration;
+    at[2] = conflicts;
+    at[3] = bestConflicts;
+    std::copy(records.begin(), records.end(), at + kMessageHeaderWords);
+    store(kWriteIndex, static_cast<std::int32_t>(next + static_cast<std::uint32_t>(length)));
+    return true;
+}
+
+BackgroundSolver::BackgroundSolver(std::unique_ptr<AlgorithmIterator> algorithm, const BackgroundSolverOptions &options)
+    : algorithm_(std::move(algorithm)), options_(options), channel_(options.ringWords)
+{
+    if (!algorithm_)
+        throw std::invalid_argument("BackgroundSolver needs an iterator");
+#if GRAPH_COLORING_THREADS
+    bestConflicts_ = algorithm_->currentConflicts();
+    const StateNode &state = algorithm_->getState();
+    std::size_t ids = state.coloring.size();
+    if (options_.mapping)
+    {
+        expanded_ = std::make_unique<ExpandedColoring>(options_.mapping);
+        expanded_->assign(state.coloring, state.palette.size());
+        ids = options_.mapping->original()->numVertices();
+    }
+    pendingSlot_.assign(ids, -1);
+    channel_.store(kIteration, algorithm_->currentIteration());
+    channel_.store(kConflicts, bestConflicts_);
+    channel_.store(kBestConflicts, bestConflicts_);
+    channel_.store(kStatus, static_cast<std::int32_t>(SolverStatus::Running));
+    thread_ = std::thread([this]
+                          { run(); });
+#else
+    throw std::runtime_error("Background runs need a threaded build (wasm: GRAPH_COLORING_WASM_THREADS)");
+#endif
+}
+
+BackgroundSolver::~BackgroundSolver()
+{
+#if GRAPH_COLORING_THREADS
+    if (thread_.joinable())
+    {
+        cancel();
+        thread_.join();
+    }
+#endif
+}
+
+void BackgroundSolver::pause()
+{
+    channel_.store(kPauseFlag, 1);
+}
+
+void BackgroundSolver::resume()
+{
+    channel_.store(kPauseFlag, 0);
+    channel_.notify(kPauseFlag);
+}
+
+void BackgroundSolver::cancel()
+{
+    channel_.store(kCancelFlag, 1);
+    resume();
+}
+
+std::unique_ptr<AlgorithmIterator> BackgroundSolver::join()
+{
+#if GRAPH_COLORING_THREADS
+    if (thread_.joinable())
+        thread_.join();
+#endif
+    if (error_)
+        std::rethrow_exception(error_);
+    return std::move(algorithm_);
+}
+
+void BackgroundSolver::collect(const std::vector<VertexChange> &log)
+{
+    const std::vector<VertexChange> *changes = &log;
+    if (expanded_)
+    {
+        expandedLog_.clear();
+        for (const VertexChange &change : log)
+            expanded_->apply(change, expandedLog_);
+        changes = &expandedLog_;
+    }
+    for (const VertexChange &change : *changes)
+    {
+        bestConflicts_ = std::min(bestConflicts_, change.conflictsAfter);
+        int &at = pendingSlot_[change.vertex];
+        if (at < 0)
+        {
+            at = static_cast<int>(pending_.size());
+            pending_.insert(pending_.end(), {static_cast<int>(change.vertex), change.oldColor, change.newColor, change.conflictsAfter});
+        }
+        else
+        {
+            pending_[at + 2] = change.newColor;
+            pending_[at + 3] = change.conflictsAfter;
+        }
+    }
+}
+
+bool BackgroundSolver::flush()
+{
+    // Vertices back on the color the consumer last saw need no record
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < pending_.size(); i += ProgressChannel::kRecordWords)
+    {
+        if (pending_[i + 1] == pending_[i + 2])
+        {
+            pendingSlot_[pending_[i]] = -1;
+            continue;
+        }
+        std::copy_n(pending_.begin() + i, ProgressChannel::kRecordWords, pending_.begin() + kept);
+        pendingSlot_[pending_[kept]] = static_cast<int>(kept);
+        kept += ProgressChannel::kRecordWords;
+    }
+    pending_.resize(kept);
+
+    const int iteration = algorithm_->currentIteration();
+    const int conflicts = algorithm_->currentConflicts();
+    const std::size_t chunk = channel_.maxRecordsPerMessage() * ProgressChannel::kRecordWords;
+    std::size_t sent = 0;
+    do
+    {
+        const std::size_t length = std::min(chunk, pending_.size() - sent);
+        if (!channel_.tryPublish(iteration, conflicts, bestConflicts_, std::span<const int>(pending_.data() + sent, length)))
+            break;
+        sent += length;
+    } while (sent < pending_.size());
+
+    if (sent > 0)
+    {
+        for (std::size_t i = 0; i < sent; i += ProgressChannel::kRecordWords)
+            pendingSlot_[pending_[i]] = -1;
+        pending_.erase(pending_.begin(), pending_.begin() + static_cast<std::ptrdiff_t>(sent));
+        for (std::size_t i = 0; i < pending_.size(); i += ProgressChannel::kRecordWords)
+            pendingSlot_[pending_[i]] = static_cast<int>(i);
+    }
+    channel_.store(kIteration, iteration);
+    channel_.store(kConflicts, conflicts);
+    channel_.store(kBestConflicts, bestConflicts_);
+    return pending_.empty();
+}
+
+void BackgroundSolver::run()
+{
+    SolverStatus status = SolverStatus::Finished;
+    try
+    {
+        bool more = true;
+        while (more)
+        {
+            if (channel_.load(kCancelFlag) != 0)
+            {
+                status = SolverStatus::Cancelled;
+                break;
+            }
+            if (channel_.load(kPauseFlag) != 0)
+            {
+                flush();
+                channel_.store(kStatus, static_cast<std::int32_t>(SolverStatus::Paused));
+                std::atomic_ref<std::int32_t>(channel_.words()[kPauseFlag]).wait(1, std::memory_order_acquire);
+                channel_.store(kStatus, static_cast<std::int32_t>(SolverStatus::Running));
+                continue;
+            }
+
+            log_.clear();
+            algorithm_->setChangeLog(&log_);
+            for (int step = 0; step < options_.stepsPerBatch && more; ++step)
+                more = algorithm_->step();
+            algorithm_->setChangeLog(nullptr);
+            collect(log_);
+            flush();
+        }
+        // The consumer must see every change before Finished; wait for it to drain the ring
+        while (status == SolverStatus::Finished && !flush())
+        {
+            if (channel_.load(kCancelFlag) != 0)
+                status = SolverStatus::Cancelled;
+            else
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    catch (...)
+    {
+        algorithm_->setChangeLog(nullptr);
+        error_ = std::current_exception();
+        status = SolverStatus::Failed;
+    }
+    channel_.store(kStatus, static_cast<std::int32_t>(status));
+    channel_.notify(kStatus);
+}
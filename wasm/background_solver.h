@@ -0,0 +1,165 @@
+#ifndef BACKGROUND_SOLVER_H
+#define BACKGROUND_SOLVER_H
+
+#include "algorithms.h"
+#include "preprocess.h"
+#include "thread_pool.h"
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <span>
+#include <vector>
+
+// Word offsets of the ProgressChannel header. The block is read from JS as an Int32Array over the
+// shared wasm memory, so the layout is part of the module's interface (see App.tsx).
+enum ProgressWord : int
+{
+    kWriteIndex,    // ring words ever written; advanced by the solver
+    kReadIndex,     // ring words ever consumed; advanced by the consumer
+    kPauseFlag,     // 1 asks the solver to pause, 0 lets it run
+    kCancelFlag,    // 1 asks the solver to stop for good
+    kStatus,        // SolverStatus
+    // Latest iteration, conflicts and fewest conflicts seen; refreshed after every batch, even
+    // while the ring is full
+    kIteration,
+    kConflicts,
+    kBestConflicts,
+    kCapacity, // ring size in words, a power of two
+    kProgressHeaderWords
+};
+
+enum class SolverStatus : std::int32_t
+{
+    Running,
+    Paused,
+    Finished,  // the iterator ran out of iterations or found a proper coloring
+    Cancelled, // stopped on request; changes still in flight were not published
+    Failed     // the iterator threw
+};
+
+// Lock-free single-producer/single-consumer channel in one block of int32 words: the header above,
+// then the ring. A message is [length, iteration, conflicts, bestConflicts] followed by
+// (vertex, oldColor, newColor, conflictsAfter) records, the same records algorithmStepN returns,
+// one per vertex whose color changed since the previous message. Messages never wrap: one that
+// does not fit before the end of the ring is preceded by a lone kWrapMarker and starts at slot 0.
+// Indices are word counts that only grow (mod 2^32); word i lives in slot i & (capacity - 1).
+class ProgressChannel
+{
+public:
+    static constexpr std::int32_t kWrapMarker = -1;
+    static constexpr std::size_t kMessageHeaderWords = 4;
+    static constexpr std::size_t kRecordWords = 4;
+
+    // capacityWords is rounded up to a power of two, at least 64
+    explicit ProgressChannel(std::size_t capacityWords);
+
+    std::span<std::int32_t> words() { return words_; }
+    std::size_t capacity() const { return words_.size() - kProgressHeaderWords; }
+    // Largest message is half the ring, so one always fits once the consumer catches up
+    std::size_t maxRecordsPerMessage() const { return (capacity() / 2 - kMessageHeaderWords) / kRecordWords; }
+
+    std::int32_t load(ProgressWord word) const;
+    void store(ProgressWord word, std::int32_t value);
+    void notify(ProgressWord word);
+
+    // Producer: append one message, or return false without writing anything when it does not fit
+    bool tryPublish(int iteration, int conflicts, int bestConflicts, std::span<const int> records);
+
+    // Consumer: visit(iteration, conflicts, bestConflicts, records) for every pending message in
+    // order, then release their space. Returns the number of messages read.
+    template <typename Visit>
+    std::size_t consume(Visit &&visit);
+
+private:
+    std::int32_t *ring() { return words_.data() + kProgressHeaderWords; }
+
+    std::vector<std::int32_t> words_;
+};
+
+struct BackgroundSolverOptions
+{
+    std::size_t ringWords = 1 << 16;
+    // Steps between publishes and checks of the pause and cancel flags
+    int stepsPerBatch = 1024;
+    // Set when the iterator searches a preprocessed graph: records are then published for the
+    // original graph, peeled vertices included (see ExpandedColoring)
+    std::shared_ptr<const VertexMapping> mapping;
+};
+
+// Runs an iterator to completion on its own thread, publishing its progress through a
+// ProgressChannel. Pausing and cancelling are cooperative: the flags are checked between batches.
+// Changes that do not fit in the ring are coalesced per vertex and sent once the consumer frees
+// space, so the search itself never waits on the UI; only the final flush before Finished does.
+// Threadless builds (wasm without -pthread) cannot construct one.
+class BackgroundSolver
+{
+public:
+    static constexpr bool kAvailable = GRAPH_COLORING_THREADS != 0;
+
+    BackgroundSolver(std::unique_ptr<AlgorithmIterator> algorithm, const BackgroundSolverOptions &options = BackgroundSolverOptions());
+    // Cancels and joins a solver still running
+    ~BackgroundSolver();
+    BackgroundSolver(const BackgroundSolver &) = delete;
+    BackgroundSolver &operator=(const BackgroundSolver &) = delete;
+
+    ProgressChannel &channel() { return channel_; }
+    SolverStatus status() const { return static_cast<SolverStatus>(channel_.load(kStatus)); }
+    bool done() const { return status() >= SolverStatus::Finished; }
+
+    void pause();
+    void resume();
+    void cancel();
+    // Wait for the thread to stop (cancel() first to stop it early) and hand the iterator back.
+    // Rethrows what the iterator threw, if anything.
+    std::unique_ptr<AlgorithmIterator> join();
+
+private:
+    void run();
+    void collect(const std::vector<VertexChange> &log);
+    // Publish as many pending records as fit; returns true once none are left
+    bool flush();
+
+    std::unique_ptr<AlgorithmIterator> algorithm_;
+    BackgroundSolverOptions options_;
+    ProgressChannel channel_;
+    // Solver thread only: coalesced records not yet published (with published ids) and published
+    // id -> record offset (-1 when none)
+    std::vector<int> pending_;
+    std::vector<int> pendingSlot_;
+    std::vector<VertexChange> log_;
+    std::unique_ptr<ExpandedColoring> expanded_; // with options.mapping only
+    std::vector<VertexChange> expandedLog_;
+    int bestConflicts_ = 0;
+    std::exception_ptr error_;
+#if GRAPH_COLORING_THREADS
+    std::thread thread_;
+#endif
+};
+
+template <typename Visit>
+std::size_t ProgressChannel::consume(Visit &&visit)
+{
+    const std::uint32_t mask = static_cast<std::uint32_t>(capacity() - 1);
+    std::uint32_t read = static_cast<std::uint32_t>(load(kReadIndex));
+    const std::uint32_t write = static_cast<std::uint32_t>(load(kWriteIndex));
+    std::size_t messages = 0;
+    while (read != write)
+    {
+        const std::uint32_t slot = read & mask;
+        const std::int32_t *message = ring() + slot;
+        if (message[0] == kWrapMarker)
+        {
+            read += static_cast<std::uint32_t>(capacity()) - slot;
+            continue;
+        }
+        const std::size_t length = static_cast<std::size_t>(message[0]);
+        visit(message[1], message[2], message[3], std::span<const int>(message + kMessageHeaderWords, length - kMessageHeaderWords));
+        read += static_cast<std::uint32_t>(length);
+        ++messages;
+    }
+    store(kReadIndex, static_cast<std::int32_t>(read));
+    return messages;
+}
+
+#endif // BACKGROUND_SOLVER_H
@@ -1,7 +1,13 @@
 
 #include <emscripten/bind.h>
 #include "graph.h"
+#include "graph_io.h"
 #include "algorithms.h"
+#include "portfolio.h"
+#include "checkpoint.h"
+#include "color_reduction.h"
+#include "background_solver.h"
+#include "preprocess.h"
 #include <memory>
 #include <optional>
 #include "init.h"
@@ -14,68 +20,94 @@ struct AlgorithmStartupOptions
     std::string algorithmName = "hill_climbing";
     int iterations = 0;
     RandomGraphOptions generationOptions;
+    // Simulated annealing only: "geometric", "linear", "logarithmic" or "adaptive"
+    std::string annealingSchedule = "geometric";
+    // "random", "greedy", "dsatur" or "rlf"
+    std::string initialColoring = "random";
+    // Constructive colorings only: start the search one color below what they used
+    bool oneColorFewer = false;
+    // Hill climbing and simulated annealing: add Kempe chain interchanges to the neighborhood
+    bool kempeChains = false;
+    // Search graph numbering: "original", "degree", "rcm" or "bfs"
+    std::string vertexOrder = "original";
+    // Constructive colorings only: color vertices with fewer neighbors than colors after the search
+    bool peel = false;
 };
 
-StateNode initialStateNode(const RandomGraphOptions &options, std::mt19937 &rng_)
+static NeighborhoodOptions neighborhoodOptions(bool kempeChains)
 {
-    auto graph = std::make_shared<Graph>(generateRandomGraph(options, rng_));
-    const auto &nodes = graph->getNodes();
-
-    // compute maxDegree once
-    int maxDegree = 0;
-    for (auto n : nodes)
-        maxDegree = std::max<int>(maxDegree, n->getNeighbors().size());
-
-    ColorPalette palette(maxDegree + 1); // enough colors for any node's incident edges
-
-    ColoringMap coloring;
-    std::map<int, int> usedColors;
-    std::uniform_int_distribution<int> colorDist(0, static_cast<int>(palette.size()) - 1);
-    for (auto node : nodes)
-    {
-        coloring[node] = palette.getColor(colorDist(rng_));
-        usedColors[coloring[node].index]++;
-    }
+    NeighborhoodOptions neighborhood;
+    neighborhood.kempeChains = kempeChains;
+    return neighborhood;
+}
 
-    int conflicts = computeConflicts(*graph, coloring);
-    return StateNode{graph, std::move(palette), std::move(coloring), conflicts, std::move(usedColors)};
+static InitialColoringOptions initialColoringOptions(const AlgorithmStartupOptions &options)
+{
+    InitialColoringOptions initial;
+    initial.method = parseInitialColoring(options.initialColoring);
+    initial.oneColorFewer = options.oneColorFewer;
+    return initial;
 }
 
-std::unique_ptr<AlgorithmIterator> initializeAlgorithm(std::unique_ptr<StateNode> initialState, const std::string &algorithmName, int iterations)
+static PreprocessOptions preprocessOptions(const AlgorithmStartupOptions &options)
 {
-    if (algorithmName == "hill_climbing")
-    {
-        return std::make_unique<HillClimbingColoringIterator>(std::move(initialState), iterations, init.getRng());
-    }
-    else if (algorithmName == "simulated_annealing")
-    {
-        return std::make_unique<SimulatedAnnealingColoringIterator>(std::move(initialState), iterations, init.getRng());
-    }
-    else if (algorithmName == "beam")
-    {
-        return std::make_unique<BeamColoringIterator>(std::move(initialState), iterations, init.getRng());
-    }
-    else
-    {
-        throw std::invalid_argument("Unknown algorithm name: " + algorithmName);
-    }
+    PreprocessOptions preprocess;
+    preprocess.order = parseVertexOrder(options.vertexOrder);
+    preprocess.peel = options.peel;
+    return preprocess;
 }
 
-// Binding: Generate and set initialStateNode in global state, return it
+static AnnealingOptions annealingOptions(const std::string &schedule)
+{
+    AnnealingOptions options;
+    options.schedule = parseCoolingSchedule(schedule);
+    return options;
+}
 
-void setInitialAlgorithmState(const AlgorithmStartupOptions &options)
+// Preprocess the graph, store the initial state and start the requested algorithm on a working copy of it
+static void startFromGraph(std::shared_ptr<Graph> graph, const AlgorithmStartupOptions &options)
 {
-    // Create fresh initial state
-    StateNode node = initialStateNode(options.generationOptions, init.getRng());
+    globalState.backgroundSolver.reset();
+    PreparedSearch prepared = prepareSearch(std::move(graph), init.getRng(), initialColoringOptions(options), preprocessOptions(options));
+    StateNode node = std::move(prepared.state);
+    globalState.vertexMapping = std::move(prepared.mapping);
+    globalState.expandedInitial.reset();
+    globalState.expandedCurrent.reset();
+    globalState.expandedCurrentStale = true;
+    if (globalState.vertexMapping)
+    {
+        globalState.expandedInitial = std::make_unique<ExpandedColoring>(globalState.vertexMapping);
+        globalState.expandedInitial->assign(node.coloring, node.palette.size());
+        globalState.expandedCurrent = std::make_unique<ExpandedColoring>(globalState.vertexMapping);
+    }
     // Store a preserved copy for retrieval (shared_ptr graph so shallow share is fine)
     globalState.initialStateNode = std::make_unique<StateNode>(node.graph, node.palette, node.coloring, node.conflicts, node.usedColors);
 
     // Create a separate working copy for the algorithm iterator so that the preserved
     // initial state remains accessible to JS unchanged.
-    auto workingCopy = std::make_unique<StateNode>(node.graph, node.palette, node.coloring, node.conflicts, node.usedColors);
+    auto workingCopy = std::make_unique<StateNode>(std::move(node));
 
-    globalState.algorithm = initializeAlgorithm(std::move(workingCopy), options.algorithmName, options.iterations);
+    globalState.algorithm = initializeAlgorithm(std::move(workingCopy), options.algorithmName, options.iterations, init.getRng(), 0, annealingOptions(options.annealingSchedule), neighborhoodOptions(options.kempeChains));
     globalState.iterationCount = options.iterations; // store requested iteration limit
+    globalState.annealingSchedule = options.annealingSchedule;
+    globalState.kempeChains = options.kempeChains;
+}
+
+// Binding: Generate and set initialStateNode in global state
+void setInitialAlgorithmState(const AlgorithmStartupOptions &options)
+{
+    startFromGraph(std::make_shared<Graph>(generateRandomGraph(options.generationOptions, init.getRng())), options);
+}
+
+// Binding: Same, but for a graph parsed from the bytes of a DIMACS .col or edge-list file
+// (a Uint8Array, e.g. from FileReader). The bytes are copied into wasm memory in one block
+// and parsed there; generationOptions are ignored.
+void setInitialAlgorithmStateFromBytes(const AlgorithmStartupOptions &options, emscripten::val bytes)
+{
+    std::vector<std::uint8_t> text = emscripten::convertJSArrayToNumberVector<std::uint8_t>(bytes);
+    auto graph = std::make_shared<Graph>(parseGraph(std::string_view(reinterpret_cast<const char *>(text.data()), text.size())));
+    text = {};
+    startFromGraph(std::move(graph), options);
 }
 
 // Binding: Get pointer to current initialStateNode in global state
@@ -84,6 +116,37 @@ std::shared_ptr<StateNode> getInitialStateNode()
     return globalState.initialStateNode;
 }
 
+// The graph colorings handed to JS refer to: the original graph when the search graph was peeled or
+// renumbered, the search graph otherwise
+std::shared_ptr<Graph> getDisplayGraph()
+{
+    if (globalState.vertexMapping)
+        return globalState.vertexMapping->original();
+    return globalState.initialStateNode ? globalState.initialStateNode->graph : nullptr;
+}
+
+// The active iterator changed other than through algorithmStepN; its coloring is expanded again
+// when next read
+static void markDisplayColoringStale()
+{
+    globalState.expandedCurrentStale = true;
+}
+
+// Coloring of the display graph: the state's own, or the expansion kept for it
+static const ColoringArray &displayColoring(const StateNode &state)
+{
+    if (!globalState.vertexMapping)
+        return state.coloring;
+    if (&state == globalState.initialStateNode.get())
+        return globalState.expandedInitial->coloring();
+    if (globalState.expandedCurrentStale)
+    {
+        globalState.expandedCurrent->assign(state.coloring, state.palette.size());
+        globalState.expandedCurrentStale = false;
+    }
+    return globalState.expandedCurrent->coloring();
+}
+
 // ---------- Helper data extraction (value-oriented) ----------
 
 // Build adjacency as JS array-of-arrays (each inner array holds neighbor indices)
@@ -93,55 +156,36 @@ emscripten::val getGraphAdjacency(std::shared_ptr<Graph> graph)
     val adj = val::array();
     if (!graph)
         return adj;
-    const auto &nodes = graph->getNodes();
-    std::unordered_map<GraphNode *, int> index;
-    index.reserve(nodes.size());
-    for (size_t i = 0; i < nodes.size(); ++i)
-    {
-        index[nodes[i].get()] = static_cast<int>(i);
-    }
-    for (size_t i = 0; i < nodes.size(); ++i)
+    for (VertexId v = 0; v < graph->numVertices(); ++v)
     {
         val nbrs = val::array();
         int pos = 0;
-        for (auto &nbr : nodes[i]->getNeighbors())
+        for (VertexId nbr : graph->neighbors(v))
         {
-            auto it = index.find(nbr.get());
-            if (it != index.end())
-            {
-                nbrs.set(pos++, it->second);
-            }
+            nbrs.set(pos++, nbr);
         }
-        adj.set(i, nbrs);
+        adj.set(v, nbrs);
     }
     return adj;
 }
 
-// Internal helper to convert a StateNode's coloring into an array (by node index) of color objects
+// Internal helper to convert a StateNode's coloring into an array (by display graph vertex) of color objects
 emscripten::val stateColorArray(const StateNode &state)
 {
     using emscripten::val;
     val arr = val::array();
     if (!state.graph)
         return arr;
-    const auto &nodes = state.graph->getNodes();
-    for (size_t i = 0; i < nodes.size(); ++i)
+    const ColoringArray &coloring = displayColoring(state);
+    for (VertexId i = 0; i < coloring.size(); ++i)
     {
-        auto it = state.coloring.find(nodes[i]);
-        if (it != state.coloring.end())
-        {
-            const Color &c = it->second;
-            val obj = val::object();
-            obj.set("index", c.index);
-            obj.set("r", c.r);
-            obj.set("g", c.g);
-            obj.set("b", c.b);
-            arr.set(i, obj);
-        }
-        else
-        {
-            arr.set(i, val::undefined());
-        }
+        const Color &c = state.palette.getColor(coloring[i]);
+        val obj = val::object();
+        obj.set("index", c.index);
+        obj.set("r", c.r);
+        obj.set("g", c.g);
+        obj.set("b", c.b);
+        arr.set(i, obj);
     }
     return arr;
 }
@@ -162,6 +206,63 @@ emscripten::val getCurrentColorArray()
     return getInitialColorArray();
 }
 
+// ---------- Zero-copy views over WASM memory ----------
+// These typed arrays alias C++ storage instead of copying it. A view is only valid until the
+// object behind it is resized or the WASM heap grows, so JS either reads a view before its next
+// call into the module or copies it (view.slice()) to keep it.
+
+// CSR offsets (numVertices + 1 entries): neighbors of v are targets[offsets[v] .. offsets[v + 1])
+emscripten::val getGraphOffsets(std::shared_ptr<Graph> graph)
+{
+    if (!graph)
+        return emscripten::val(typed_memory_view<EdgeOffset>(0, nullptr));
+    return emscripten::val(typed_memory_view(graph->offsets().size(), graph->offsets().data()));
+}
+
+// CSR neighbor ids, every undirected edge appears once from each endpoint
+emscripten::val getGraphTargets(std::shared_ptr<Graph> graph)
+{
+    if (!graph)
+        return emscripten::val(typed_memory_view<VertexId>(0, nullptr));
+    return emscripten::val(typed_memory_view(graph->targets().size(), graph->targets().data()));
+}
+
+static const StateNode *currentStateNode()
+{
+    if (globalState.algorithm)
+        return &globalState.algorithm->getState();
+    return globalState.initialStateNode.get();
+}
+
+// Color index of every display graph vertex as an Int32Array
+emscripten::val stateColorIndices(const StateNode *state)
+{
+    if (!state)
+        return emscripten::val(typed_memory_view<int>(0, nullptr));
+    const ColoringArray &coloring = displayColoring(*state);
+    return emscripten::val(typed_memory_view(coloring.size(), coloring.data()));
+}
+
+emscripten::val getInitialColorIndices()
+{
+    return stateColorIndices(globalState.initialStateNode.get());
+}
+
+emscripten::val getCurrentColorIndices()
+{
+    return stateColorIndices(currentStateNode());
+}
+
+// Palette as packed RGB bytes: color i is at [3 * i, 3 * i + 3)
+emscripten::val getPaletteRGB()
+{
+    const StateNode *state = currentStateNode();
+    if (!state)
+        return emscripten::val(typed_memory_view<std::uint8_t>(0, nullptr));
+    const auto &rgb = state->palette.packedRGB();
+    return emscripten::val(typed_memory_view(rgb.size(), rgb.data()));
+}
+
 EMSCRIPTEN_BINDINGS(RandomGraphOptions)
 {
     value_object<RandomGraphOptions>("RandomGraphOptions")
@@ -175,7 +276,13 @@ EMSCRIPTEN_BINDINGS(AlgorithmStartupOptions)
     value_object<AlgorithmStartupOptions>("AlgorithmStartupOptions")
         .field("algorithmName", &AlgorithmStartupOptions::algorithmName)
         .field("iterations", &AlgorithmStartupOptions::iterations)
-        .field("generationOptions", &AlgorithmStartupOptions::generationOptions);
+        .field("generationOptions", &AlgorithmStartupOptions::generationOptions)
+        .field("annealingSchedule", &AlgorithmStartupOptions::annealingSchedule)
+        .field("initialColoring", &AlgorithmStartupOptions::initialColoring)
+        .field("oneColorFewer", &AlgorithmStartupOptions::oneColorFewer)
+        .field("kempeChains", &AlgorithmStartupOptions::kempeChains)
+        .field("vertexOrder", &AlgorithmStartupOptions::vertexOrder)
+        .field("peel", &AlgorithmStartupOptions::peel);
 }
 
 EMSCRIPTEN_BINDINGS(Color)
@@ -187,17 +294,6 @@ EMSCRIPTEN_BINDINGS(Color)
         .field("b", &Color::b);
 }
 
-EMSCRIPTEN_BINDINGS(GraphNode)
-{
-    register_vector<std::shared_ptr<GraphNode>>("VectorGraphNodePtr");
-
-    class_<GraphNode>("GraphNode")
-        .smart_ptr<std::shared_ptr<GraphNode>>("GraphNode")
-        // Revert to default copy semantics to avoid binding issues with const refs.
-        // Frontend now avoids this path (uses adjacency helpers), so occasional copies are acceptable.
-        .property("neighbors", &GraphNode::getNeighbors);
-}
-
 EMSCRIPTEN_BINDINGS(ColorPalette)
 {
     register_vector<Color>("ColorPaletteVector");
@@ -209,9 +305,7 @@ EMSCRIPTEN_BINDINGS(ColorPalette)
 
 EMSCRIPTEN_BINDINGS(StateNode)
 {
-    // Register map and vector types for JS interop
-    register_map<std::shared_ptr<GraphNode>, Color>("ColoringMap");
-    register_map<int, int>("UsedColorsMap");
+    // Coloring and color usage are both dense int arrays
     register_vector<int>("VectorInt");
     class_<StateNode>("StateNode")
         .smart_ptr<std::shared_ptr<StateNode>>("StateNode")
@@ -230,24 +324,19 @@ EMSCRIPTEN_BINDINGS(Graph)
 {
     class_<Graph>("Graph")
         .smart_ptr<std::shared_ptr<Graph>>("Graph")
-        // Using default behavior (copy). Visualization now uses getGraphAdjacency() so this is rarely invoked.
-        .function("getNodes", &Graph::getNodes);
+        // Visualization uses getGraphAdjacency(); only the sizes are exposed on the handle.
+        .function("numVertices", &Graph::numVertices)
+        .function("numEdges", &Graph::numEdges);
 }
 
-// Run greedy removal on the current algorithm state and recompute conflicts/usage
+// Run conflict repair on the current algorithm state; the iterator rebuilds its own bookkeeping
+// around the repaired coloring, so stepping can continue from it
 void runGreedyRemoveConflicts()
 {
     if (!globalState.algorithm)
         throw std::runtime_error("Algorithm not initialized");
-    StateNode &st = const_cast<StateNode &>(globalState.algorithm->getState());
-    greedyRemoveConflicts(st);
-    st.conflicts = computeConflicts(*st.graph, st.coloring);
-    // recompute usedColors map
-    st.usedColors.clear();
-    for (auto &kv : st.coloring)
-    {
-        st.usedColors[kv.second.index]++;
-    }
+    globalState.algorithm->repair();
+    markDisplayColoringStale();
 }
 
 // Reinitialize algorithm iterator from preserved initialStateNode without regenerating graph
@@ -257,8 +346,263 @@ void reinitializeAlgorithm(const std::string &algorithmName, int iterations)
         throw std::runtime_error("No preserved initial state to reinitialize from");
     // Make a working copy so original stays immutable for further resets
     auto workingCopy = std::make_unique<StateNode>(*globalState.initialStateNode);
-    globalState.algorithm = initializeAlgorithm(std::move(workingCopy), algorithmName, iterations);
+    globalState.algorithm = initializeAlgorithm(std::move(workingCopy), algorithmName, iterations, init.getRng(), 0, annealingOptions(globalState.annealingSchedule), neighborhoodOptions(globalState.kempeChains));
     globalState.iterationCount = iterations;
+    markDisplayColoringStale();
+}
+
+// Run `runs` independent iterators (cycling through the JS array of algorithm names, seeds from the
+// shared rng) from fresh random colorings of the preserved initial state, and return the winner.
+// The active iterator is left untouched.
+std::shared_ptr<StateNode> runPortfolioFromInitial(emscripten::val algorithmNames, int runs, int iterations)
+{
+    if (!globalState.initialStateNode)
+        throw std::runtime_error("No preserved initial state to run a portfolio from");
+    auto names = emscripten::vecFromJSArray<std::string>(algorithmNames);
+    PortfolioOptions options;
+    options.entries = makePortfolioEntries(names, runs > 0 ? static_cast<std::size_t>(runs) : names.size(), init.getRng());
+    options.iterations = iterations;
+    PortfolioResult result = runPortfolio(*globalState.initialStateNode, options);
+    return std::shared_ptr<StateNode>(std::move(result.state));
+}
+
+// Minimize the colors of the active iterator's coloring with reduceColors, launching
+// `algorithmName` with `iterationsPerRun` per k, for at most timeLimitSeconds (0: until a launch
+// fails). The fewest-color legal state found becomes the active iterator, restarted with the
+// same algorithm and iteration count. Returns { bestColors, iterations, runs }.
+emscripten::val runColorReduction(const std::string &algorithmName, int iterationsPerRun, double timeLimitSeconds)
+{
+    if (!globalState.algorithm)
+        throw std::runtime_error("Algorithm not initialized");
+    // Retiring colors would drop the palette below the peeling threshold
+    if (globalState.vertexMapping && globalState.vertexMapping->peelColors() > 0)
+        throw std::runtime_error("Color reduction is not available on a peeled graph");
+    ColorReductionOptions options;
+    options.algorithmName = algorithmName;
+    options.iterationsPerRun = iterationsPerRun;
+    options.timeLimitSeconds = timeLimitSeconds;
+    options.annealing = annealingOptions(globalState.annealingSchedule);
+    options.neighborhood = neighborhoodOptions(globalState.kempeChains);
+    ColorReductionResult result = reduceColors(globalState.algorithm->getState(), options, init.getRng());
+    if (result.bestColors > 0)
+    {
+        const std::string activeName = globalState.algorithm->name();
+        globalState.algorithm = initializeAlgorithm(std::make_unique<StateNode>(std::move(result.best)), activeName, globalState.iterationCount,
+                                                    init.getRng(), 0, options.annealing, options.neighborhood);
+        markDisplayColoringStale();
+    }
+    emscripten::val obj = emscripten::val::object();
+    obj.set("bestColors", result.bestColors);
+    obj.set("iterations", static_cast<double>(result.iterations));
+    obj.set("runs", static_cast<double>(result.runs.size()));
+    return obj;
+}
+
+// Move the active iterator onto a solver thread (needs a GRAPH_COLORING_WASM_THREADS build),
+// publishing progress every stepsPerBatch steps. Until finishBackgroundRun the module has no
+// active iterator. Progress is read from getProgressChannel without calling into the module.
+void startBackgroundRun(int stepsPerBatch)
+{
+    if (!globalState.algorithm)
+        throw std::runtime_error("Algorithm not initialized");
+    if (globalState.backgroundSolver)
+        throw std::runtime_error("A background run is already active");
+    // Checked before the iterator is handed over, so a threadless module keeps it
+    if (!BackgroundSolver::kAvailable)
+        throw std::runtime_error("Background runs need a module built with GRAPH_COLORING_WASM_THREADS");
+    BackgroundSolverOptions options;
+    if (stepsPerBatch > 0)
+        options.stepsPerBatch = stepsPerBatch;
+    options.mapping = globalState.vertexMapping;
+    globalState.backgroundSolver = std::make_unique<BackgroundSolver>(std::move(globalState.algorithm), options);
+}
+
+// The background run's ProgressChannel (header words, then the ring) as an Int32Array over the
+// shared wasm memory; see background_solver.h for the layout. The block never moves while the
+// run is active, so the view stays valid even if the heap grows.
+emscripten::val getProgressChannel()
+{
+    if (!globalState.backgroundSolver)
+        throw std::runtime_error("No background run");
+    auto words = globalState.backgroundSolver->channel().words();
+    return emscripten::val(typed_memory_view(words.size(), words.data()));
+}
+
+static BackgroundSolver &backgroundSolver()
+{
+    if (!globalState.backgroundSolver)
+        throw std::runtime_error("No background run");
+    return *globalState.backgroundSolver;
+}
+
+// Join the background run, cancelling it first if it is still going, and make its iterator the
+// active one again
+void finishBackgroundRun()
+{
+    std::unique_ptr<BackgroundSolver> solver = std::move(globalState.backgroundSolver);
+    if (!solver)
+        throw std::runtime_error("No background run");
+    if (!solver->done())
+        solver->cancel();
+    globalState.algorithm = solver->join();
+    markDisplayColoringStale();
+}
+
+// Phase timers and counters of the active iterator as { enabled, steps, selectionNs, evaluationNs,
+// commitNs, kLeastNs, stepNs, movesEvaluated, movesAccepted, allocations, bytesAllocated, bytesCopied }
+// (numbers; all zero unless the module was built with GRAPH_COLORING_STATS)
+emscripten::val getSearchStats()
+{
+    if (!globalState.algorithm)
+        throw std::runtime_error("Algorithm not initialized");
+    SearchStats stats = globalState.algorithm->searchStats();
+    emscripten::val obj = emscripten::val::object();
+    obj.set("enabled", kStatsEnabled);
+    obj.set("steps", static_cast<double>(stats.steps));
+    obj.set("selectionNs", static_cast<double>(stats.selectionNs));
+    obj.set("evaluationNs", static_cast<double>(stats.evaluationNs));
+    obj.set("commitNs", static_cast<double>(stats.commitNs));
+    obj.set("kLeastNs", static_cast<double>(stats.kLeastNs));
+    obj.set("stepNs", static_cast<double>(stats.stepNs));
+    obj.set("movesEvaluated", static_cast<double>(stats.movesEvaluated));
+    obj.set("movesAccepted", static_cast<double>(stats.movesAccepted));
+    obj.set("allocations", static_cast<double>(stats.allocations));
+    obj.set("bytesAllocated", static_cast<double>(stats.bytesAllocated));
+    obj.set("bytesCopied", static_cast<double>(stats.bytesCopied));
+    return obj;
+}
+
+// Snapshot the active iterator (graph, coloring and full search state) as a Uint8Array view of a
+// module-owned buffer; copy it (e.g. bytes.slice()) before the next saveCheckpoint call.
+emscripten::val saveCheckpointBytes()
+{
+    if (!globalState.algorithm)
+        throw std::runtime_error("Algorithm not initialized");
+    globalState.checkpointBytes = saveCheckpoint(*globalState.algorithm);
+    return emscripten::val(emscripten::typed_memory_view(globalState.checkpointBytes.size(), globalState.checkpointBytes.data()));
+}
+
+// Resume from a Uint8Array produced by saveCheckpoint. The checkpointed coloring becomes the
+// preserved initial state, so reinitializeAlgorithm restarts from it. A background run still going
+// is cancelled and joined, and its iterator dropped.
+void restoreCheckpointBytes(emscripten::val bytes)
+{
+    std::vector<std::uint8_t> data = emscripten::convertJSArrayToNumberVector<std::uint8_t>(bytes);
+    auto algorithm = loadCheckpoint(data);
+    // A live background run owns the iterator being replaced; stop it before anything changes
+    globalState.backgroundSolver.reset();
+    const StateNode &state = algorithm->getState();
+    globalState.initialStateNode = std::make_shared<StateNode>(state.graph, state.palette, state.coloring, state.conflicts, state.usedColors);
+    globalState.iterationCount = algorithm->maxIterations();
+    // A checkpoint holds the search graph only; its colorings are shown on that graph
+    globalState.vertexMapping.reset();
+    globalState.expandedInitial.reset();
+    globalState.expandedCurrent.reset();
+    // reinitializeAlgorithm and background runs reuse these, so they follow the restored search
+    globalState.annealingSchedule = "geometric";
+    globalState.kempeChains = false;
+    if (auto *annealing = dynamic_cast<const SimulatedAnnealingColoringIterator *>(algorithm.get()))
+    {
+        globalState.annealingSchedule = coolingScheduleName(annealing->annealing().schedule);
+        globalState.kempeChains = annealing->neighborhood().kempeChains;
+    }
+    else if (auto *climbing = dynamic_cast<const HillClimbingColoringIterator *>(algorithm.get()))
+        globalState.kempeChains = climbing->neighborhood().kempeChains;
+    globalState.algorithm = std::move(algorithm);
+}
+
+// Per-rung move and exchange counters of the active parallel tempering iterator, coldest rung
+// first, as [{ temperature, proposed, accepted, swapsProposed, swapsAccepted }]; empty for other algorithms
+emscripten::val getReplicaStats()
+{
+    emscripten::val result = emscripten::val::array();
+    auto *tempering = dynamic_cast<const ParallelTemperingColoringIterator *>(globalState.algorithm.get());
+    if (!tempering)
+        return result;
+    int i = 0;
+    for (const ReplicaStats &rung : tempering->replicaStats())
+    {
+        emscripten::val obj = emscripten::val::object();
+        obj.set("temperature", rung.temperature);
+        obj.set("proposed", static_cast<double>(rung.proposed));
+        obj.set("accepted", static_cast<double>(rung.accepted));
+        obj.set("swapsProposed", static_cast<double>(rung.swapsProposed));
+        obj.set("swapsAccepted", static_cast<double>(rung.swapsAccepted));
+        result.set(i++, obj);
+    }
+    return result;
+}
+
+// Advance up to n iterations inside C++ and report only what changed:
+// { changes, steps, conflicts, color, continueIteration }. `changes` is an Int32Array view of
+// (vertex, oldColor, newColor, conflictsAfter) records, one per vertex whose color differs from
+// before the call; it is valid until the next call into the module.
+emscripten::val algorithmStepN(int n)
+{
+    if (!globalState.algorithm)
+        throw std::runtime_error("Algorithm not initialized");
+    AlgorithmIterator &algorithm = *globalState.algorithm;
+    // The expansion must match the coloring the change log starts from
+    if (globalState.vertexMapping)
+        displayColoring(algorithm.getState());
+    auto &log = globalState.changeLog;
+    log.clear();
+    algorithm.setChangeLog(&log);
+    bool cont = true;
+    int steps = 0;
+    for (; steps < n && cont; ++steps)
+        cont = algorithm.step();
+    algorithm.setChangeLog(nullptr);
+
+    // On a preprocessed graph the records are for the original one, with the peeled vertices each
+    // search recolor moves
+    const std::vector<VertexChange> *changes = &log;
+    if (globalState.vertexMapping)
+    {
+        globalState.expandedChangeLog.clear();
+        for (const VertexChange &change : log)
+            globalState.expandedCurrent->apply(change, globalState.expandedChangeLog);
+        changes = &globalState.expandedChangeLog;
+    }
+
+    // Coalesce repeated recolors of a vertex into one record, then drop vertices back on their old color
+    auto &delta = globalState.stepDelta;
+    auto &slot = globalState.deltaSlot;
+    delta.clear();
+    for (const VertexChange &change : *changes)
+    {
+        if (change.vertex >= slot.size())
+            slot.resize(change.vertex + 1, -1);
+        int &at = slot[change.vertex];
+        if (at < 0)
+        {
+            at = static_cast<int>(delta.size());
+            delta.insert(delta.end(), {static_cast<int>(change.vertex), change.oldColor, change.newColor, change.conflictsAfter});
+        }
+        else
+        {
+            delta[at + 2] = change.newColor;
+            delta[at + 3] = change.conflictsAfter;
+        }
+    }
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < delta.size(); i += 4)
+    {
+        slot[delta[i]] = -1;
+        if (delta[i + 1] == delta[i + 2])
+            continue;
+        std::copy(delta.begin() + i, delta.begin() + i + 4, delta.begin() + kept);
+        kept += 4;
+    }
+    delta.resize(kept);
+
+    emscripten::val result = emscripten::val::object();
+    result.set("changes", emscripten::val(typed_memory_view(delta.size(), delta.data())));
+    result.set("steps", steps);
+    result.set("conflicts", algorithm.currentConflicts());
+    result.set("color", log.empty() ? -1 : log.back().newColor);
+    result.set("continueIteration", cont);
+    return result;
 }
 
 EMSCRIPTEN_BINDINGS(StepResult)
@@ -273,37 +617,70 @@ EMSCRIPTEN_BINDINGS(StepResult)
 EMSCRIPTEN_BINDINGS(my_module)
 {
     function("setInitialAlgorithmState", &setInitialAlgorithmState);
+    function("setInitialAlgorithmStateFromBytes", &setInitialAlgorithmStateFromBytes);
     function("getInitialStateNode", &getInitialStateNode);
+    function("getDisplayGraph", &getDisplayGraph);
     // Value extraction helpers (arrays only; no GraphNode wrappers required for visualization)
     function("getGraphAdjacency", &getGraphAdjacency);
     function("getInitialColorArray", &getInitialColorArray);
     function("getCurrentColorArray", &getCurrentColorArray);
+    // Zero-copy typed array views (see the note above getGraphOffsets)
+    function("getGraphOffsets", &getGraphOffsets);
+    function("getGraphTargets", &getGraphTargets);
+    function("getInitialColorIndices", &getInitialColorIndices);
+    function("getCurrentColorIndices", &getCurrentColorIndices);
+    function("getPaletteRGB", &getPaletteRGB);
     // New algorithm control bindings
-    // step now returns pair<int, Color>
     function("algorithmStep", +[]() -> StepResult
              {
         if (!globalState.algorithm)
             throw std::runtime_error("Algorithm not initialized");
-        StateNode st = globalState.algorithm->step(); // copy
-        return StepResult(st.node, st.color, st.conflicts, st.continueIteration); });
+        bool cont = globalState.algorithm->step();
+        markDisplayColoringStale();
+        const StateNode &st = globalState.algorithm->getState();
+        int node = st.node;
+        if (globalState.vertexMapping && node >= 0)
+            node = static_cast<int>(globalState.vertexMapping->toOriginal()[node]);
+        // No color was applied yet, or it was retired by a color reduction: index -1, like algorithmStepN's
+        const Color color = st.color >= 0 ? st.palette.getColor(st.color) : Color{-1, 0, 0, 0};
+        return StepResult(node, color, st.conflicts, cont); });
+    function("algorithmStepN", &algorithmStepN);
     function("algorithmRunToEnd", +[]()
                                   {
         if (!globalState.algorithm)
             throw std::runtime_error("Algorithm not initialized");
-        globalState.algorithm->runToEnd(); });
-    function("getCurrentAlgorithmState", +[]() -> StateNode *
+        globalState.algorithm->runToEnd();
+        markDisplayColoringStale(); });
+    function("getCurrentAlgorithmState", +[]() -> const StateNode *
              {
         if (!globalState.algorithm)
             return nullptr;
-        // getState returns const ref; cast away const for embind (JS won't mutate internal fields directly)
-        return const_cast<StateNode *>(&globalState.algorithm->getState()); }, allow_raw_pointers());
+        // embind hands JS a const handle; changes go through the iterator (e.g. runGreedyRemoveConflicts)
+        return &globalState.algorithm->getState(); }, allow_raw_pointers());
     function("runGreedyRemoveConflicts", &runGreedyRemoveConflicts);
     // Reset only the active algorithm iterator, preserving the stored initialStateNode so JS can re-use it.
     function("resetAlgorithm", +[]()
                                {
+        globalState.backgroundSolver.reset();
         globalState.algorithm.reset();
-        globalState.iterationCount = 0; });
+        globalState.iterationCount = 0;
+        markDisplayColoringStale(); });
     function("reinitializeAlgorithm", &reinitializeAlgorithm);
+    function("runPortfolio", &runPortfolioFromInitial);
+    function("runColorReduction", &runColorReduction);
+    function("startBackgroundRun", &startBackgroundRun);
+    function("getProgressChannel", &getProgressChannel);
+    function("pauseBackgroundRun", +[]()
+             { backgroundSolver().pause(); });
+    function("resumeBackgroundRun", +[]()
+             { backgroundSolver().resume(); });
+    function("cancelBackgroundRun", +[]()
+             { backgroundSolver().cancel(); });
+    function("finishBackgroundRun", &finishBackgroundRun);
+    function("getReplicaStats", &getReplicaStats);
+    function("getSearchStats", &getSearchStats);
+    function("saveCheckpoint", &saveCheckpointBytes);
+    function("restoreCheckpoint", &restoreCheckpointBytes);
     function("getCurrentIteration", +[]() -> int
              {
         if (!globalState.algorithm) return 0;
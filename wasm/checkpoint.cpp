@@ -0,0 +1,118 @@
+#include "checkpoint.h"
+#include "algorithms.h"
+#include "graph_io.h"
+#include <cstdio>
+#include <fstream>
+
+namespace
+{
+constexpr char kMagic[8] = {'G', 'C', 'O', 'L', 'C', 'K', 'P', 'T'};
+
+// CSR arrays Graph can index without bounds checks
+void checkGraph(std::span<const EdgeOffset> offsets, std::span<const VertexId> targets)
+{
+    if (offsets.empty() || offsets.front() != 0 || offsets.back() != targets.size())
+        throw std::runtime_error("Corrupt graph in checkpoint");
+    if (std::adjacent_find(offsets.begin(), offsets.end(), std::greater<EdgeOffset>()) != offsets.end())
+        throw std::runtime_error("Corrupt graph in checkpoint");
+    const std::size_t numVertices = offsets.size() - 1;
+    if (std::any_of(targets.begin(), targets.end(), [&](VertexId v)
+                    { return v >= numVertices; }))
+        throw std::runtime_error("Corrupt graph in checkpoint");
+}
+}
+
+void checkCheckpointColoring(std::span<const int> coloring, std::size_t numVertices, int numColors)
+{
+    if (coloring.size() != numVertices)
+        throw std::runtime_error("Checkpoint coloring does not match its graph");
+    if (std::any_of(coloring.begin(), coloring.end(), [&](int c)
+                    { return c < 0 || c >= numColors; }))
+        throw std::runtime_error("Corrupt coloring in checkpoint");
+}
+
+void checkCheckpointNodeColor(int node, int color, std::size_t numVertices, int numColors)
+{
+    if (node < -1 || (node >= 0 && static_cast<std::size_t>(node) >= numVertices) || color < -1 || color >= numColors)
+        throw std::runtime_error("Corrupt vertex or color in checkpoint");
+}
+
+std::vector<std::uint8_t> saveCheckpoint(const AlgorithmIterator &algorithm)
+{
+    const StateNode &state = algorithm.getState();
+    CheckpointWriter out;
+    out.write(kMagic);
+    out.write(kCheckpointVersion);
+    out.write<std::uint32_t>(0); // reserved
+    out.writeString(algorithm.name());
+    out.write<std::int32_t>(algorithm.maxIterations());
+
+    out.writeArray(state.graph->offsets());
+    out.writeArray(state.graph->targets());
+    out.write<std::int32_t>(state.palette.size());
+    out.writeArray(state.coloring);
+    out.write<std::int32_t>(state.node);
+    out.write<std::int32_t>(state.color);
+    state.conflictQueue.save(out);
+
+    algorithm.saveState(out);
+    return out.take();
+}
+
+std::unique_ptr<AlgorithmIterator> loadCheckpoint(std::span<const std::uint8_t> bytes, unsigned numThreads)
+{
+    CheckpointReader in(bytes);
+    auto magic = in.read<std::array<char, sizeof(kMagic)>>();
+    if (!std::equal(magic.begin(), magic.end(), kMagic))
+        throw std::runtime_error("Not a graph coloring checkpoint");
+    auto version = in.read<std::uint32_t>();
+    if (version != kCheckpointVersion)
+        throw std::runtime_error("Unsupported checkpoint version " + std::to_string(version));
+    in.read<std::uint32_t>();
+    std::string algorithmName = in.readString();
+    int maxIterations = in.read<std::int32_t>();
+
+    auto offsets = in.readArray<EdgeOffset>();
+    auto targets = in.readArray<VertexId>();
+    checkGraph(offsets, targets);
+    auto graph = std::make_shared<Graph>(std::vector<EdgeOffset>(offsets.begin(), offsets.end()), std::vector<VertexId>(targets.begin(), targets.end()));
+    // Palettes start at maxDegree + 1 colors (random) or at most one per vertex (constructive)
+    int numColors = in.read<std::int32_t>();
+    if (numColors < 1 || static_cast<std::size_t>(numColors) > std::max<std::size_t>(graph->maxDegree() + 1, graph->numVertices()))
+        throw std::runtime_error("Corrupt palette size in checkpoint");
+    auto coloring = in.readArray<int>();
+    checkCheckpointColoring(coloring, graph->numVertices(), numColors);
+    const std::size_t numVertices = graph->numVertices();
+    auto state = std::make_unique<StateNode>(stateFromColoring(std::move(graph), ColorPalette(numColors), ColoringArray(coloring.begin(), coloring.end())));
+    state->node = in.read<std::int32_t>();
+    state->color = in.read<std::int32_t>();
+    checkCheckpointNodeColor(state->node, state->color, numVertices, numColors);
+    state->conflictQueue.restore(in);
+
+    // The RNG passed here is replaced by the saved stream in restoreState
+    auto algorithm = initializeAlgorithm(std::move(state), algorithmName, maxIterations, std::mt19937(), numThreads);
+    algorithm->restoreState(in);
+    return algorithm;
+}
+
+void saveCheckpointFile(const AlgorithmIterator &algorithm, const std::string &path)
+{
+    std::vector<std::uint8_t> bytes = saveCheckpoint(algorithm);
+    // Write beside the target and rename, so an interrupted save never clobbers the last good checkpoint
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        if (!out.flush())
+            throw std::runtime_error("Cannot write " + temporary);
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0)
+        throw std::runtime_error("Cannot replace " + path);
+}
+
+std::unique_ptr<AlgorithmIterator> loadCheckpointFile(const std::string &path, unsigned numThreads)
+{
+    MappedFile file(path);
+    std::string_view text = file.view();
+    return loadCheckpoint(std::span<const std::uint8_t>(reinterpret_cast<const std::uint8_t *>(text.data()), text.size()), numThreads);
+}
@@ -0,0 +1,169 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+struct AlgorithmIterator;
+
+// Checkpoints are raw little-endian dumps; every wasm and native target we build for is little-endian.
+static_assert(std::endian::native == std::endian::little, "Checkpoint format assumes a little-endian host");
+
+// Bumped whenever the layout of any section changes; older or newer files are rejected.
+constexpr std::uint32_t kCheckpointVersion = 4;
+
+// Appends scalars and length-prefixed arrays. Array payloads start on 8-byte boundaries, so a
+// mapped checkpoint can be read in place without copying or misaligned loads.
+class CheckpointWriter
+{
+public:
+    template <typename T>
+    void write(const T &value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        append(&value, sizeof(T));
+    }
+
+    template <typename T>
+    void writeArray(std::span<const T> values)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        write<std::uint64_t>(values.size());
+        pad();
+        append(values.data(), values.size_bytes());
+        pad();
+    }
+
+    template <typename T>
+    void writeArray(const std::vector<T> &values) { writeArray(std::span<const T>(values)); }
+
+    void writeString(std::string_view text) { writeArray(std::span<const char>(text.data(), text.size())); }
+
+    // The full Mersenne Twister state, in the textual form the standard library round-trips exactly
+    template <typename Engine>
+    void writeEngine(const Engine &engine)
+    {
+        std::ostringstream out;
+        out << engine;
+        writeString(out.str());
+    }
+
+    const std::vector<std::uint8_t> &bytes() const { return bytes_; }
+    std::vector<std::uint8_t> take() { return std::move(bytes_); }
+
+private:
+    void append(const void *data, std::size_t size)
+    {
+        if (size == 0)
+            return;
+        std::size_t at = bytes_.size();
+        bytes_.resize(at + size);
+        std::memcpy(bytes_.data() + at, data, size);
+    }
+    void pad() { bytes_.resize((bytes_.size() + 7) & ~std::size_t{7}, 0); }
+
+    std::vector<std::uint8_t> bytes_;
+};
+
+// Reads what CheckpointWriter wrote. Arrays come back as views into the buffer, which must
+// outlive them and start 8-byte aligned (true for mappings and heap allocations).
+class CheckpointReader
+{
+public:
+    explicit CheckpointReader(std::span<const std::uint8_t> bytes) : bytes_(bytes) {}
+
+    template <typename T>
+    T read()
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value;
+        std::memcpy(&value, take(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    std::span<const T> readArray()
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        auto count = read<std::uint64_t>();
+        pad();
+        if (count > (bytes_.size() - offset_) / sizeof(T))
+            throw std::runtime_error("Truncated checkpoint");
+        const auto *data = reinterpret_cast<const T *>(take(count * sizeof(T)));
+        pad();
+        return {data, static_cast<std::size_t>(count)};
+    }
+
+    template <typename T>
+    std::vector<T> readVector()
+    {
+        auto values = readArray<T>();
+        return {values.begin(), values.end()};
+    }
+
+    std::string readString()
+    {
+        auto chars = readArray<char>();
+        return {chars.begin(), chars.end()};
+    }
+
+    // Bytes not read yet; bounds element counts before anything is allocated for them
+    std::size_t remaining() const { return bytes_.size() - offset_; }
+
+    template <typename Engine>
+    void readEngine(Engine &engine)
+    {
+        std::istringstream in(readString());
+        in >> engine;
+        if (in.fail())
+            throw std::runtime_error("Corrupt RNG state in checkpoint");
+    }
+
+private:
+    const std::uint8_t *take(std::size_t size)
+    {
+        if (size > bytes_.size() - offset_)
+            throw std::runtime_error("Truncated checkpoint");
+        const std::uint8_t *at = bytes_.data() + offset_;
+        offset_ += size;
+        return at;
+    }
+    void pad() { offset_ = std::min(bytes_.size(), (offset_ + 7) & ~std::size_t{7}); }
+
+    std::span<const std::uint8_t> bytes_;
+    std::size_t offset_ = 0;
+};
+
+// Range checks for the values a restore indexes arrays with, so a truncated or damaged file is
+// rejected before anything is built from it. Both throw std::runtime_error.
+// Every vertex colored, every color in [0, numColors)
+void checkCheckpointColoring(std::span<const int> coloring, std::size_t numVertices, int numColors);
+// A StateNode's last vertex and color: -1 or in range
+void checkCheckpointNodeColor(int node, int color, std::size_t numVertices, int numColors);
+
+// Snapshot of an iterator: graph (CSR arrays), palette size, reported coloring and the
+// iterator's own state (iteration counter, RNG streams, tabu table, beam, temperature, ...).
+std::vector<std::uint8_t> saveCheckpoint(const AlgorithmIterator &algorithm);
+
+// Rebuild the iterator a checkpoint was taken from. Per-vertex conflict counters and other
+// indexes derived from the coloring are rebuilt in O(V + E); the search continues exactly
+// where it stopped. numThreads is as for initializeAlgorithm().
+std::unique_ptr<AlgorithmIterator> loadCheckpoint(std::span<const std::uint8_t> bytes, unsigned numThreads = 0);
+
+// File variants: saving writes a temporary file and renames it over path, loading maps the file.
+void saveCheckpointFile(const AlgorithmIterator &algorithm, const std::string &path);
+std::unique_ptr<AlgorithmIterator> loadCheckpointFile(const std::string &path, unsigned numThreads = 0);
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,478 @@
+// Native command-line driver: build or load a graph, run one iterator and report timings
+#include "graph.h"
+#include "graph_io.h"
+#include "algorithms.h"
+#include "portfolio.h"
+#include "checkpoint.h"
+#include "color_reduction.h"
+#include "background_solver.h"
+#include "preprocess.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct CliOptions
+{
+    std::string algorithmName = "hill_climbing";
+    std::string inputPath;
+    RandomGraphOptions generationOptions{1000, 5000, false};
+    unsigned int seed = 42;
+    int iterations = 100000;
+    unsigned threads = 0;
+    AnnealingOptions annealing;
+    InitialColoringOptions initialColoring;
+    PreprocessOptions preprocess;
+    NeighborhoodOptions neighborhood;
+    // Run repairConflicts on the final state
+    bool repair = false;
+    // Run the iterator on a BackgroundSolver and follow it through the progress ring, the way the
+    // browser UI does
+    bool background = false;
+    // Minimize the number of colors with reduceColors; iterations is the budget of each launch
+    bool reduceColors = false;
+    long long totalIterations = 0;
+    double timeLimit = 0.0;
+    // Comma-separated algorithms for a multi-start portfolio; empty runs a single iterator
+    std::vector<std::string> portfolio;
+    std::size_t runs = 0;
+    // Save the search to checkpointPath every checkpointEvery iterations and at the end;
+    // resumePath continues a saved search instead of starting a new one
+    std::string checkpointPath;
+    int checkpointEvery = 0;
+    std::string resumePath;
+    // Where to write SearchStats as JSON, "-" for stdout; empty skips it
+    std::string statsPath;
+    // Fail if steps after the first allocationWarmup iterations allocate; -1 skips the check
+    int allocationWarmup = -1;
+};
+
+static void writeStats(const CliOptions &options, const SearchStats &stats)
+{
+    if (options.statsPath.empty())
+        return;
+    if (!kStatsEnabled)
+        std::cerr << "warning: built without GRAPH_COLORING_STATS, every counter is zero\n";
+    if (options.statsPath == "-")
+    {
+        std::cout << stats.toJson() << "\n";
+        return;
+    }
+    std::ofstream out(options.statsPath);
+    if (!(out << stats.toJson() << "\n"))
+        throw std::runtime_error("Cannot write " + options.statsPath);
+}
+
+static std::vector<std::string> splitList(const std::string &list)
+{
+    std::vector<std::string> items;
+    std::istringstream in(list);
+    std::string item;
+    while (std::getline(in, item, ','))
+    {
+        if (!item.empty())
+            items.push_back(item);
+    }
+    return items;
+}
+
+static void printUsage(const char *program)
+{
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --algorithm NAME   hill_climbing | simulated_annealing | parallel_tempering | tabu | beam\n                     (default hill_climbing)\n"
+              << "  --input PATH       load a DIMACS .col or \"u v\" edge-list file instead of generating\n"
+              << "  --vertices N       vertices of the generated G(n, m) graph (default 1000)\n"
+              << "  --edges M          edges of the generated graph (default 5000)\n"
+              << "  --seed S           seed for graph generation, initial coloring and search (default 42)\n"
+              << "  --iterations N     iteration budget (default 100000)\n"
+              << "  --threads N        worker threads for parallel iterators (default 0 = all cores)\n"
+              << "  --schedule NAME    annealing schedule: geometric | linear | logarithmic | adaptive (default geometric)\n"
+              << "  --init NAME        initial coloring: random | greedy | dsatur | rlf (default random)\n"
+              << "  --one-color-fewer  start a constructive coloring's search at one color below what it used\n"
+              << "  --order NAME       renumber the search graph: original | degree | rcm | bfs (default original)\n"
+              << "  --peel             set aside vertices with fewer neighbors than the start palette has colors\n"
+              << "                     and color them after the search (needs --init greedy, dsatur or rlf)\n"
+              << "  --repair           run the conflict repair post-pass on the final coloring\n"
+              << "  --background       run the search on a solver thread and mirror the coloring from its\n"
+              << "                     progress ring, polling every 16 ms\n"
+              << "  --kempe            add Kempe chain interchanges to hill climbing and simulated annealing\n"
+              << "  --kempe-rate P     fraction of annealing proposals that are Kempe interchanges (default 0.2)\n"
+              << "  --reduce-colors    minimize the number of colors: retire a color after every legal coloring\n"
+              << "                     and relaunch the algorithm, each launch with the --iterations budget\n"
+              << "  --total-iterations N  iteration budget of the whole --reduce-colors run (default unlimited)\n"
+              << "  --time-limit S     time budget of the whole --reduce-colors run in seconds (default unlimited)\n"
+              << "  --checkpoint PATH  save the search state to PATH when the run ends\n"
+              << "  --checkpoint-every N  also save it every N iterations\n"
+              << "  --resume PATH      continue the search saved in PATH (graph and algorithm options are ignored)\n"
+              << "  --stats-json PATH  write step() phase timers and counters as JSON to PATH, - for stdout\n"
+              << "                     (needs a build with -DGRAPH_COLORING_STATS=ON)\n"
+              << "  --check-allocations N  fail unless steps after the first N iterations make no heap\n"
+              << "                     allocations (needs a build with -DGRAPH_COLORING_STATS=ON)\n"
+              << "  --portfolio LIST   run comma-separated algorithms concurrently from independent starts\n"
+              << "  --runs N           portfolio size, cycling through LIST (default: one run per entry)\n";
+}
+
+static CliOptions parseArgs(int argc, char const *argv[])
+{
+    CliOptions options;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h")
+        {
+            printUsage(argv[0]);
+            std::exit(0);
+        }
+        if (arg == "--one-color-fewer")
+        {
+            options.initialColoring.oneColorFewer = true;
+            continue;
+        }
+        if (arg == "--peel")
+        {
+            options.preprocess.peel = true;
+            continue;
+        }
+        if (arg == "--repair")
+        {
+            options.repair = true;
+            continue;
+        }
+        if (arg == "--background")
+        {
+            options.background = true;
+            continue;
+        }
+        if (arg == "--reduce-colors")
+        {
+            options.reduceColors = true;
+            continue;
+        }
+        if (arg == "--kempe")
+        {
+            options.neighborhood.kempeChains = true;
+            continue;
+        }
+        if (i + 1 >= argc)
+            throw std::invalid_argument("Missing value for " + arg);
+        std::string value = argv[++i];
+        if (arg == "--algorithm")
+            options.algorithmName = value;
+        else if (arg == "--input")
+            options.inputPath = value;
+        else if (arg == "--vertices")
+            options.generationOptions.numVertices = std::stoull(value);
+        else if (arg == "--edges")
+            options.generationOptions.numEdges = std::stoull(value);
+        else if (arg == "--seed")
+            options.seed = static_cast<unsigned int>(std::stoul(value));
+        else if (arg == "--iterations")
+            options.iterations = std::stoi(value);
+        else if (arg == "--threads")
+            options.threads = static_cast<unsigned>(std::stoul(value));
+        else if (arg == "--schedule")
+            options.annealing.schedule = parseCoolingSchedule(value);
+        else if (arg == "--kempe-rate")
+            options.neighborhood.kempeRate = std::stod(value);
+        else if (arg == "--total-iterations")
+            options.totalIterations = std::stoll(value);
+        else if (arg == "--time-limit")
+            options.timeLimit = std::stod(value);
+        else if (arg == "--init")
+            options.initialColoring.method = parseInitialColoring(value);
+        else if (arg == "--order")
+            options.preprocess.order = parseVertexOrder(value);
+        else if (arg == "--checkpoint")
+            options.checkpointPath = value;
+        else if (arg == "--checkpoint-every")
+            options.checkpointEvery = std::stoi(value);
+        else if (arg == "--resume")
+            options.resumePath = value;
+        else if (arg == "--stats-json")
+            options.statsPath = value;
+        else if (arg == "--check-allocations")
+            options.allocationWarmup = std::stoi(value);
+        else if (arg == "--portfolio")
+            options.portfolio = splitList(value);
+        else if (arg == "--runs")
+            options.runs = std::stoull(value);
+        else
+            throw std::invalid_argument("Unknown option " + arg);
+    }
+    return options;
+}
+
+static std::shared_ptr<Graph> loadOrGenerateGraph(const CliOptions &options, std::mt19937 &rng)
+{
+    if (options.inputPath.empty())
+        return std::make_shared<Graph>(generateRandomGraph(options.generationOptions, rng, options.threads));
+    return std::make_shared<Graph>(loadGraphFile(options.inputPath, options.threads));
+}
+
+static int runPortfolioMode(const CliOptions &options, std::mt19937 &rng)
+{
+    auto setupStart = std::chrono::steady_clock::now();
+    auto graph = loadOrGenerateGraph(options, rng);
+    StateNode initial = prepareSearch(graph, rng, options.initialColoring, options.preprocess).state;
+    PortfolioOptions portfolio;
+    // Redrawing random starts would throw away a constructive coloring
+    portfolio.randomStart = options.initialColoring.method == InitialColoring::Random;
+    portfolio.entries = makePortfolioEntries(options.portfolio, options.runs ? options.runs : options.portfolio.size(), rng);
+    portfolio.iterations = options.iterations;
+    portfolio.numThreads = options.threads;
+    double setupSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - setupStart).count();
+
+    auto runStart = std::chrono::steady_clock::now();
+    PortfolioResult result = runPortfolio(initial, portfolio);
+    double runSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - runStart).count();
+
+    long long totalIterations = 0;
+    for (const PortfolioRun &run : result.runs)
+        totalIterations += run.iterations;
+    std::cout << "vertices:          " << graph->numVertices() << "\n"
+              << "edges:             " << graph->numEdges() << "\n"
+              << "palette size:      " << initial.palette.size() << "\n"
+              << "setup time (s):    " << setupSeconds << "\n"
+              << "run time (s):      " << runSeconds << "\n"
+              << "iterations/s:      " << (runSeconds > 0 ? totalIterations / runSeconds : 0.0) << "\n";
+    for (std::size_t i = 0; i < result.runs.size(); ++i)
+    {
+        const PortfolioRun &run = result.runs[i];
+        std::cout << "run " << i << ": " << portfolio.entries[i].algorithmName
+                  << " seed=" << portfolio.entries[i].seed << " iterations=" << run.iterations
+                  << " conflicts=" << run.conflicts << (run.cancelled ? " (cancelled)" : "") << "\n";
+    }
+    std::cout << "winner:            run " << result.winner << " (" << portfolio.entries[result.winner].algorithmName << ")\n"
+              << "final conflicts:   " << result.state->conflicts << "\n";
+    SearchStats stats;
+    for (const PortfolioRun &run : result.runs)
+        stats += run.stats;
+    writeStats(options, stats);
+    return 0;
+}
+
+static int runColorReductionMode(const CliOptions &options, std::mt19937 &rng)
+{
+    // Retiring colors would drop the palette below the peeling threshold
+    if (options.preprocess.peel)
+        throw std::invalid_argument("--peel cannot be combined with --reduce-colors");
+    auto setupStart = std::chrono::steady_clock::now();
+    auto graph = loadOrGenerateGraph(options, rng);
+    StateNode initial = prepareSearch(graph, rng, options.initialColoring, options.preprocess).state;
+    ColorReductionOptions reduction;
+    reduction.algorithmName = options.algorithmName;
+    reduction.iterationsPerRun = options.iterations;
+    reduction.maxIterations = options.totalIterations;
+    reduction.timeLimitSeconds = options.timeLimit;
+    reduction.numThreads = options.threads;
+    reduction.annealing = options.annealing;
+    reduction.neighborhood = options.neighborhood;
+    const int startColors = initial.palette.size();
+    double setupSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - setupStart).count();
+
+    auto runStart = std::chrono::steady_clock::now();
+    ColorReductionResult result = reduceColors(std::move(initial), reduction, rng);
+    double runSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - runStart).count();
+
+    std::cout << "algorithm:         " << options.algorithmName << "\n"
+              << "vertices:          " << graph->numVertices() << "\n"
+              << "edges:             " << graph->numEdges() << "\n"
+              << "palette size:      " << startColors << "\n"
+              << "setup time (s):    " << setupSeconds << "\n"
+              << "run time (s):      " << runSeconds << "\n"
+              << "iterations:        " << result.iterations << "\n";
+    for (const ColorReductionRun &run : result.runs)
+    {
+        std::cout << "k=" << run.colors << ": iterations=" << run.iterations << " conflicts=" << run.conflicts
+                  << " time=" << run.seconds << "s\n";
+    }
+    if (result.bestColors > 0)
+        std::cout << "best colors:       " << result.bestColors << "\n";
+    else
+        std::cout << "best colors:       none (no legal coloring found)\n";
+    writeStats(options, result.stats);
+    return 0;
+}
+
+// Consume the ring at a frame-like cadence into a copy of the coloring, then check the copy
+// against the state the solver hands back
+// With a mapping the mirror is the coloring of the original graph, peeled vertices included
+static ColoringArray displayColoring(const StateNode &state, const std::shared_ptr<const VertexMapping> &mapping)
+{
+    if (!mapping)
+        return state.coloring;
+    ExpandedColoring expanded(mapping);
+    expanded.assign(state.coloring, state.palette.size());
+    return expanded.coloring();
+}
+
+static std::unique_ptr<AlgorithmIterator> runInBackground(std::unique_ptr<AlgorithmIterator> algorithm, const std::shared_ptr<const VertexMapping> &mapping)
+{
+    ColoringArray mirror = displayColoring(algorithm->getState(), mapping);
+    BackgroundSolverOptions solverOptions;
+    solverOptions.mapping = mapping;
+    BackgroundSolver solver(std::move(algorithm), solverOptions);
+    std::size_t polls = 0, messages = 0, records = 0;
+    int bestConflicts = 0;
+    for (bool done = false; !done;)
+    {
+        // Read the status first: everything published before Finished is then in the ring
+        done = solver.done();
+        messages += solver.channel().consume([&](int, int, int best, std::span<const int> changes)
+                                             {
+            bestConflicts = best;
+            for (std::size_t i = 0; i < changes.size(); i += ProgressChannel::kRecordWords)
+                mirror[changes[i]] = changes[i + 2];
+            records += changes.size() / ProgressChannel::kRecordWords; });
+        ++polls;
+        if (!done)
+            std::this_thread::sleep_for(std::chrono::milliseconds(16));
+    }
+    const bool finished = solver.status() == SolverStatus::Finished;
+    algorithm = solver.join();
+    const bool exact = mirror == displayColoring(algorithm->getState(), mapping);
+    std::cout << "progress polls:    " << polls << " (" << messages << " messages, " << records << " records)\n"
+              << "best conflicts:    " << bestConflicts << "\n"
+              << "mirrored coloring: " << (exact ? "exact" : "differs") << "\n";
+    if (finished && !exact)
+        throw std::runtime_error("The progress ring lost changes");
+    return algorithm;
+}
+
+int main(int argc, char const *argv[])
+{
+    try
+    {
+        CliOptions options = parseArgs(argc, argv);
+        std::mt19937 rng(options.seed);
+        if (!options.portfolio.empty())
+            return runPortfolioMode(options, rng);
+        if (options.reduceColors)
+            return runColorReductionMode(options, rng);
+
+        auto setupStart = std::chrono::steady_clock::now();
+        std::unique_ptr<AlgorithmIterator> algorithm;
+        std::shared_ptr<const VertexMapping> mapping;
+        if (!options.resumePath.empty())
+        {
+            algorithm = loadCheckpointFile(options.resumePath, options.threads);
+        }
+        else
+        {
+            auto graph = loadOrGenerateGraph(options, rng);
+            PreparedSearch prepared = prepareSearch(graph, rng, options.initialColoring, options.preprocess);
+            mapping = std::move(prepared.mapping);
+            auto state = std::make_unique<StateNode>(std::move(prepared.state));
+            algorithm = initializeAlgorithm(std::move(state), options.algorithmName, options.iterations, rng, options.threads, options.annealing, options.neighborhood);
+        }
+        int initialConflicts = algorithm->currentConflicts();
+        int startIteration = algorithm->currentIteration();
+        double setupSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - setupStart).count();
+
+        const bool checkAllocations = options.allocationWarmup >= 0;
+        if (checkAllocations && !kStatsEnabled)
+            throw std::runtime_error("--check-allocations needs a build with -DGRAPH_COLORING_STATS=ON");
+        std::optional<std::uint64_t> warmupAllocations;
+
+        auto runStart = std::chrono::steady_clock::now();
+        if (options.background)
+        {
+            if (!options.checkpointPath.empty() || checkAllocations)
+                throw std::runtime_error("--background cannot be combined with --checkpoint or --check-allocations");
+            algorithm = runInBackground(std::move(algorithm), mapping);
+        }
+        else if (options.checkpointPath.empty() && !checkAllocations)
+        {
+            algorithm->runToEnd();
+        }
+        else
+        {
+            int sinceCheckpoint = 0;
+            while (algorithm->step())
+            {
+                if (checkAllocations && !warmupAllocations && algorithm->currentIteration() >= options.allocationWarmup)
+                    warmupAllocations = algorithm->searchStats().allocations;
+                if (!options.checkpointPath.empty() && options.checkpointEvery > 0 && ++sinceCheckpoint == options.checkpointEvery)
+                {
+                    sinceCheckpoint = 0;
+                    saveCheckpointFile(*algorithm, options.checkpointPath);
+                }
+            }
+            if (!options.checkpointPath.empty())
+                saveCheckpointFile(*algorithm, options.checkpointPath);
+        }
+        double runSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - runStart).count();
+
+        const StateNode &result = algorithm->getState();
+        const Graph &graph = *result.graph;
+        int colorsUsed = 0;
+        for (int usage : result.usedColors)
+        {
+            if (usage > 0)
+                ++colorsUsed;
+        }
+        int iterations = algorithm->currentIteration();
+        int iterationsRun = iterations - startIteration;
+
+        std::cout << "algorithm:         " << algorithm->name() << "\n"
+                  << "neighbor scan:     " << GRAPH_COLORING_NEIGHBOR_SCAN << "\n"
+                  << "vertices:          " << graph.numVertices() << "\n"
+                  << "edges:             " << graph.numEdges() << "\n"
+                  << "palette size:      " << result.palette.size() << "\n"
+                  << "setup time (s):    " << setupSeconds << "\n"
+                  << "run time (s):      " << runSeconds << "\n"
+                  << "iterations:        " << iterations << "\n"
+                  << "iterations/s:      " << (runSeconds > 0 ? iterationsRun / runSeconds : 0.0) << "\n"
+                  << "initial conflicts: " << initialConflicts << "\n"
+                  << "final conflicts:   " << result.conflicts << "\n"
+                  << "colors used:       " << colorsUsed << "\n";
+        if (mapping)
+        {
+            ColoringArray expanded = displayColoring(result, mapping);
+            std::cout << "original graph:    " << mapping->original()->numVertices() << " vertices";
+            if (mapping->peelColors() > 0)
+                std::cout << ", " << mapping->peeled().size() << " peeled below " << mapping->peelColors() << " neighbors";
+            std::cout << "\noriginal conflicts: " << computeConflicts(*mapping->original(), expanded) << "\n";
+        }
+        if (auto *tempering = dynamic_cast<const ParallelTemperingColoringIterator *>(algorithm.get()))
+        {
+            for (const ReplicaStats &rung : tempering->replicaStats())
+            {
+                std::cout << "replica T=" << rung.temperature << ": accepted " << rung.accepted << "/" << rung.proposed
+                          << ", swaps " << rung.swapsAccepted << "/" << rung.swapsProposed << "\n";
+            }
+        }
+        if (options.repair)
+        {
+            StateNode repaired = result;
+            auto repairStart = std::chrono::steady_clock::now();
+            RepairResult repair = repairConflicts(repaired);
+            double repairSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - repairStart).count();
+            std::cout << "repaired conflicts: " << repaired.conflicts << " (" << repair.recolorings << " recolorings, "
+                      << repairSeconds << " s)\n";
+        }
+        writeStats(options, algorithm->searchStats());
+        if (checkAllocations)
+        {
+            if (!warmupAllocations)
+                throw std::runtime_error("The run ended within the --check-allocations warm-up");
+            std::uint64_t steady = algorithm->searchStats().allocations - *warmupAllocations;
+            std::cout << "steady allocations: " << steady << " after iteration " << options.allocationWarmup << "\n";
+            if (steady > 0)
+                return 1;
+        }
+        return 0;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "error: " << e.what() << "\n";
+        return 1;
+    }
+}
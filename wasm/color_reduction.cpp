@@ -0,0 +1,72 @@
+#include "color_reduction.h"
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+ColorReductionResult reduceColors(StateNode state, const ColorReductionOptions &options, std::mt19937 &rng)
+{
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+    auto outOfTime = [&]
+    {
+        return options.timeLimitSeconds > 0.0 && std::chrono::duration<double>(Clock::now() - start).count() >= options.timeLimitSeconds;
+    };
+    auto outOfIterations = [&](long long iterations)
+    {
+        return options.maxIterations > 0 && iterations >= options.maxIterations;
+    };
+    const bool unbounded = options.maxIterations <= 0 && options.timeLimitSeconds <= 0.0;
+    // Steps between clock reads
+    constexpr int kCheckInterval = 1024;
+
+    ColorReductionResult result;
+    while (!outOfTime() && !outOfIterations(result.iterations))
+    {
+        if (state.conflicts == 0)
+        {
+            result.bestColors = state.palette.size();
+            result.best = state;
+            if (result.bestColors <= std::max(1, options.targetColors))
+                break;
+            int leastUsed = static_cast<int>(std::min_element(state.usedColors.begin(), state.usedColors.end()) - state.usedColors.begin());
+            state.removeColor(leastUsed);
+            continue;
+        }
+
+        ColorReductionRun run;
+        run.colors = state.palette.size();
+        const auto runStart = Clock::now();
+        int budget = options.iterationsPerRun;
+        if (options.maxIterations > 0)
+            budget = static_cast<int>(std::min<long long>(budget, options.maxIterations - result.iterations));
+        auto algorithm = initializeAlgorithm(std::make_unique<StateNode>(std::move(state)), options.algorithmName, budget, std::mt19937(rng()),
+                                             options.numThreads, options.annealing, options.neighborhood);
+        const int firstIteration = algorithm->currentIteration();
+        int sinceCheck = 0;
+        bool stopped = false;
+        while (algorithm->step())
+        {
+            if (++sinceCheck == kCheckInterval)
+            {
+                sinceCheck = 0;
+                if (outOfTime())
+                {
+                    stopped = true;
+                    break;
+                }
+            }
+        }
+        run.iterations = algorithm->currentIteration() - firstIteration;
+        const bool gaveUp = algorithm->currentIteration() < algorithm->maxIterations() || run.iterations == 0;
+        state = algorithm->releaseState();
+        run.conflicts = state.conflicts;
+        run.seconds = std::chrono::duration<double>(Clock::now() - runStart).count();
+        result.iterations += run.iterations;
+        result.stats += algorithm->searchStats();
+        result.runs.push_back(run);
+
+        if (run.conflicts > 0 && !stopped && (unbounded || gaveUp))
+            break;
+    }
+    return result;
+}
@@ -0,0 +1,50 @@
+#ifndef COLOR_REDUCTION_H
+#define COLOR_REDUCTION_H
+
+#include "algorithms.h"
+#include <random>
+#include <string>
+#include <vector>
+
+struct ColorReductionOptions
+{
+    std::string algorithmName = "tabu";
+    // Budget of each launch of the iterator
+    int iterationsPerRun = 100000;
+    // Whole-driver budgets; 0 leaves that budget unlimited. With neither set the driver stops at
+    // the first launch that fails to find a legal coloring.
+    long long maxIterations = 0;
+    double timeLimitSeconds = 0.0;
+    // Stop once a legal coloring uses this many colors
+    int targetColors = 1;
+    unsigned numThreads = 0;
+    AnnealingOptions annealing;
+    NeighborhoodOptions neighborhood;
+};
+
+// One launch of the iterator at a fixed palette size
+struct ColorReductionRun
+{
+    int colors = 0;
+    int iterations = 0;
+    int conflicts = 0; // when the launch ended; 0 means colors was reached
+    double seconds = 0.0;
+};
+
+struct ColorReductionResult
+{
+    int bestColors = 0; // fewest colors of a legal coloring found, 0 if none was
+    StateNode best;     // the state holding that coloring, over colors 0..bestColors-1
+    std::vector<ColorReductionRun> runs;
+    long long iterations = 0;
+    SearchStats stats;
+};
+
+// Minimize the number of colors. Whenever the chosen iterator reaches zero conflicts, the least
+// used color is retired in place (StateNode::removeColor) and a fresh iterator is launched on the
+// same state, so each k starts warm from the k + 1 solution instead of from scratch. A launch
+// that ends with conflicts is relaunched at the same k with a new seed from where it stopped;
+// one that gives up before its budget (hill climbing at a local minimum) ends the driver.
+ColorReductionResult reduceColors(StateNode state, const ColorReductionOptions &options, std::mt19937 &rng);
+
+#endif // COLOR_REDUCTION_H
@@ -1,90 +1,202 @@
 #include "graph.h"
 // Implementation details for graph generation
+#include "thread_pool.h"
 #include <random>
-#include <chrono>
-#include <unordered_map>
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <stdexcept>
+#include <string>
 
-void GraphNode::addNeighbor(const std::shared_ptr<GraphNode> &neighbor)
+Graph::Graph(std::vector<EdgeOffset> offsets, std::vector<VertexId> targets)
+    : offsets_(std::move(offsets)), targets_(std::move(targets))
 {
-    neighbors.push_back(neighbor);
+    std::size_t selfEntries = 0;
+    for (std::size_t v = 0; v < numVertices(); ++v)
+    {
+        for (VertexId nbr : neighbors(static_cast<VertexId>(v)))
+            selfEntries += nbr == v;
+    }
+    selfLoops_ = selfEntries / 2;
 }
 
-const std::vector<std::shared_ptr<GraphNode>> &GraphNode::getNeighbors() const
+std::size_t Graph::maxDegree() const
 {
-    return neighbors;
+    std::size_t result = 0;
+    for (std::size_t v = 0; v < numVertices(); ++v)
+        result = std::max(result, degree(static_cast<VertexId>(v)));
+    return result;
 }
 
-void Graph::addNode(const std::shared_ptr<GraphNode> &node)
+GraphBuilder::GraphBuilder(std::size_t numVertices)
+    : numVertices_(numVertices)
 {
-    nodes_.push_back(node);
 }
 
-void Graph::addEdge(const std::shared_ptr<GraphNode> &a, const std::shared_ptr<GraphNode> &b)
+GraphBuilder::GraphBuilder(std::size_t numVertices, std::vector<std::pair<VertexId, VertexId>> edges)
+    : numVertices_(numVertices), edges_(std::move(edges))
 {
-    a->addNeighbor(b);
-    b->addNeighbor(a);
 }
 
-void Graph::reserveNodes(std::size_t n)
+void GraphBuilder::reserveEdges(std::size_t m)
 {
-    nodes_.reserve(n);
+    edges_.reserve(m);
 }
 
-const std::vector<std::shared_ptr<GraphNode>> &Graph::getNodes() const
+void GraphBuilder::addEdge(VertexId a, VertexId b)
 {
-    return nodes_;
+    edges_.emplace_back(a, b);
 }
 
-Graph generateRandomGraph(const RandomGraphOptions &options, std::mt19937 &rng)
-
+Graph GraphBuilder::build() const
 {
-    Graph graph;
-    if (options.numVertices == 0)
-        return graph;
+    // Count degrees, prefix-sum them into offsets, then scatter both directions of every edge
+    std::vector<EdgeOffset> offsets(numVertices_ + 1, 0);
+    for (const auto &[a, b] : edges_)
+    {
+        ++offsets[a + 1];
+        ++offsets[b + 1];
+    }
+    for (std::size_t v = 0; v < numVertices_; ++v)
+        offsets[v + 1] += offsets[v];
 
-    // Create vertices
-    graph.reserveNodes(options.numVertices);
-    for (std::size_t i = 0; i < options.numVertices; ++i)
+    std::vector<VertexId> targets(offsets[numVertices_]);
+    std::vector<EdgeOffset> cursor(offsets.begin(), offsets.end() - 1);
+    for (const auto &[a, b] : edges_)
     {
-        graph.addNode(std::make_shared<GraphNode>());
+        targets[cursor[a]++] = b;
+        targets[cursor[b]++] = a;
     }
+    return Graph(std::move(offsets), std::move(targets));
+}
 
-    // Set up RNG
-    std::uniform_int_distribution<std::size_t> dist(0, options.numVertices - 1);
+namespace
+{
+// Candidates are drawn in fixed-size blocks, each from its own engine seeded serially from the
+// caller's rng, so the sampled graph depends on the seed but not on the number of threads.
+constexpr std::size_t kSampleBlock = std::size_t{1} << 16;
 
-    // Track existing edges to prevent parallel edges
-    std::unordered_map<std::size_t, std::size_t> existingEdges;
-    std::size_t edgesAdded = 0;
-    while (edgesAdded < options.numEdges)
+// Uniformly pick `count` distinct values from [0, universe), returned sorted. Values are drawn
+// i.i.d. in parallel, sorted and deduplicated, and only the shortfall is drawn again. The procedure
+// treats every label alike, so each count-subset is equally likely; for count <= universe / 2 the
+// expected number of draws stays below 2 * count.
+std::vector<std::uint64_t> sampleDistinct(std::uint64_t universe, std::size_t count, std::mt19937 &rng, ThreadPool &pool)
+{
+    std::vector<std::uint64_t> chosen;
+    std::vector<std::uint64_t> batch;
+    std::vector<std::uint64_t> merged;
+    while (chosen.size() < count)
     {
-        std::size_t uIndex = dist(rng);
-        std::size_t vIndex = dist(rng);
+        std::size_t need = count - chosen.size();
+        std::size_t numBlocks = (need + kSampleBlock - 1) / kSampleBlock;
+        std::vector<std::uint32_t> seeds(numBlocks);
+        for (auto &seed : seeds)
+            seed = rng();
 
-        if (!options.allowSelfLoops && options.numVertices > 1)
-        {
-            for (int attempts = 0; vIndex == uIndex && attempts < 5; ++attempts)
+        batch.resize(need);
+        pool.parallelFor(numBlocks, [&](std::size_t begin, std::size_t end, unsigned)
+                         {
+            std::uniform_int_distribution<std::uint64_t> dist(0, universe - 1);
+            for (std::size_t block = begin; block < end; ++block)
             {
-                vIndex = dist(rng);
-            }
+                std::mt19937_64 engine(seeds[block]);
+                auto first = batch.begin() + block * kSampleBlock;
+                auto last = batch.begin() + std::min(need, (block + 1) * kSampleBlock);
+                for (auto it = first; it != last; ++it)
+                    *it = dist(engine);
+                std::sort(first, last);
+            } });
+        // Merge the sorted blocks pairwise, doubling the run length each round
+        for (std::size_t width = kSampleBlock; width < need; width *= 2)
+        {
+            std::size_t numPairs = (need + 2 * width - 1) / (2 * width);
+            pool.parallelFor(numPairs, [&](std::size_t begin, std::size_t end, unsigned)
+                             {
+                for (std::size_t pair = begin; pair < end; ++pair)
+                {
+                    std::size_t first = pair * 2 * width;
+                    std::size_t mid = std::min(need, first + width);
+                    std::size_t last = std::min(need, first + 2 * width);
+                    std::inplace_merge(batch.begin() + first, batch.begin() + mid, batch.begin() + last);
+                } });
         }
+        batch.erase(std::unique(batch.begin(), batch.end()), batch.end());
 
-        // Always store edge as (min, max) for undirected graph
-        std::size_t a = std::min(uIndex, vIndex);
-        std::size_t b = std::max(uIndex, vIndex);
-        if (!options.allowSelfLoops && a == b)
-            continue;
+        // A batch holds at most `need` distinct values, so the union never exceeds count
+        merged.clear();
+        merged.reserve(chosen.size() + batch.size());
+        std::set_union(chosen.begin(), chosen.end(), batch.begin(), batch.end(), std::back_inserter(merged));
+        chosen.swap(merged);
+    }
+    return chosen;
+}
+
+// Enumerates the pairs a <= b (with self-loops) or a < b (without) row by row in lexicographic order
+struct PairIndex
+{
+    std::uint64_t numVertices;
+    std::uint64_t rowWidth; // pairs in row 0: n with self-loops, n - 1 without
 
-        const auto &nodes = graph.getNodes();
-        if (existingEdges[a] != b)
+    std::uint64_t size() const { return rowWidth * (rowWidth + 1) / 2; }
+
+    // Index of the first pair in row a; the even factor is halved first so nothing overflows
+    std::uint64_t rowStart(std::uint64_t a) const
+    {
+        std::uint64_t other = 2 * rowWidth - a + 1;
+        return a % 2 == 0 ? (a / 2) * other : a * (other / 2);
+    }
+
+    std::pair<VertexId, VertexId> decode(std::uint64_t k) const
+    {
+        // Invert rowStart with a square root, then correct for rounding
+        double w = 2.0 * static_cast<double>(rowWidth) + 1.0;
+        double root = std::sqrt(std::max(0.0, w * w - 8.0 * static_cast<double>(k)));
+        auto a = static_cast<std::uint64_t>(std::max(0.0, std::floor((w - root) / 2.0)));
+        a = std::min(a, rowWidth - 1);
+        while (a > 0 && rowStart(a) > k)
+            --a;
+        while (a + 1 < rowWidth && rowStart(a + 1) <= k)
+            ++a;
+        std::uint64_t b = (numVertices - rowWidth) + a + (k - rowStart(a));
+        return {static_cast<VertexId>(a), static_cast<VertexId>(b)};
+    }
+};
+}
+
+Graph generateRandomGraph(const RandomGraphOptions &options, std::mt19937 &rng, unsigned numThreads)
+{
+    if (options.numVertices == 0)
+        return Graph();
+
+    PairIndex pairs{options.numVertices, options.allowSelfLoops ? options.numVertices : options.numVertices - 1};
+    std::uint64_t universe = pairs.size();
+    if (options.numEdges > universe)
+        throw std::invalid_argument("Requested " + std::to_string(options.numEdges) + " edges, but the graph has room for only " + std::to_string(universe));
+
+    ThreadPool pool(numThreads);
+    // Past half of all pairs it is cheaper to sample the pairs that are left out
+    bool complement = options.numEdges > universe / 2;
+    std::vector<std::uint64_t> sampled = sampleDistinct(universe, complement ? universe - options.numEdges : options.numEdges, rng, pool);
+    if (complement)
+    {
+        std::vector<std::uint64_t> kept;
+        kept.reserve(options.numEdges);
+        auto skip = sampled.begin();
+        for (std::uint64_t k = 0; k < universe; ++k)
         {
-            auto u = nodes[uIndex];
-            auto v = nodes[vIndex];
-            graph.addEdge(u, v);
-            existingEdges[a] = b;
-            ++edgesAdded;
+            if (skip != sampled.end() && *skip == k)
+                ++skip;
+            else
+                kept.push_back(k);
         }
-        // else: skip, try again
+        sampled.swap(kept);
     }
 
-    return graph;
-}
\ No newline at end of file
+    // Sorted pair indices decode to edges sorted by (a, b), which leaves every CSR row sorted too
+    std::vector<std::pair<VertexId, VertexId>> edges(sampled.size());
+    pool.parallelFor(sampled.size(), [&](std::size_t begin, std::size_t end, unsigned)
+                     {
+        for (std::size_t i = begin; i < end; ++i)
+            edges[i] = pairs.decode(sampled[i]); });
+    return GraphBuilder(options.numVertices, std::move(edges)).build();
+}
@@ -3,30 +3,58 @@
 
 #include <vector>
 #include <random>
-#include <emscripten/bind.h>
-#include "init.h"
+#include <span>
+#include <cstdint>
+#include <utility>
 
-class GraphNode
+// Vertices are contiguous 32-bit ids in [0, numVertices()).
+using VertexId = std::uint32_t;
+using EdgeOffset = std::uint32_t;
+
+// Undirected graph in compressed-sparse-row form: the neighbors of v are
+// targets_[offsets_[v] .. offsets_[v + 1]), every edge is stored in both directions.
+class Graph
 {
 public:
-    GraphNode() = default;
-    void addNeighbor(const std::shared_ptr<GraphNode> &neighbor);
-    const std::vector<std::shared_ptr<GraphNode>> &getNeighbors() const;
+    Graph() = default;
+    Graph(std::vector<EdgeOffset> offsets, std::vector<VertexId> targets);
+
+    std::size_t numVertices() const { return offsets_.empty() ? 0 : offsets_.size() - 1; }
+    std::size_t numEdges() const { return targets_.size() / 2; }
+
+    std::span<const VertexId> neighbors(VertexId v) const
+    {
+        return {targets_.data() + offsets_[v], targets_.data() + offsets_[v + 1]};
+    }
+
+    std::size_t degree(VertexId v) const { return offsets_[v + 1] - offsets_[v]; }
+    std::size_t maxDegree() const;
+    // Edges {v, v}; each appears twice in v's neighbor list
+    std::size_t numSelfLoops() const { return selfLoops_; }
+
+    const std::vector<EdgeOffset> &offsets() const { return offsets_; }
+    const std::vector<VertexId> &targets() const { return targets_; }
 
 private:
-    std::vector<std::shared_ptr<GraphNode>> neighbors;
+    std::vector<EdgeOffset> offsets_;
+    std::vector<VertexId> targets_;
+    std::size_t selfLoops_ = 0;
 };
 
-class Graph
+// Collects an undirected edge list and packs it into a Graph with a counting sort.
+class GraphBuilder
 {
 public:
-    void addNode(const std::shared_ptr<GraphNode> &node);
-    void addEdge(const std::shared_ptr<GraphNode> &a, const std::shared_ptr<GraphNode> &b);
-    void reserveNodes(std::size_t n);
-    const std::vector<std::shared_ptr<GraphNode>> &getNodes() const;
+    explicit GraphBuilder(std::size_t numVertices);
+    // Adopt an existing edge list instead of copying it edge by edge
+    GraphBuilder(std::size_t numVertices, std::vector<std::pair<VertexId, VertexId>> edges);
+    void reserveEdges(std::size_t m);
+    void addEdge(VertexId a, VertexId b);
+    Graph build() const;
 
 private:
-    std::vector<std::shared_ptr<GraphNode>> nodes_;
+    std::size_t numVertices_;
+    std::vector<std::pair<VertexId, VertexId>> edges_;
 };
 
 struct RandomGraphOptions
@@ -36,5 +64,7 @@ struct RandomGraphOptions
     bool allowSelfLoops = false;
 };
 
-Graph generateRandomGraph(const RandomGraphOptions &options, std::mt19937 &rng);
-#endif
\ No newline at end of file
+// Uniform G(n, m): exactly numEdges distinct edges, sampled in O(m) expected time. Work is split over
+// numThreads threads (0 = all cores); the result depends only on rng, not on the thread count.
+Graph generateRandomGraph(const RandomGraphOptions &options, std::mt19937 &rng, unsigned numThreads = 0);
+#endif
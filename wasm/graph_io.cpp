@@ -0,0 +1,293 @@
+#include "graph_io.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if !defined(__EMSCRIPTEN__) && (defined(__unix__) || defined(__APPLE__))
+#define GRAPH_IO_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define GRAPH_IO_MMAP 0
+#endif
+
+namespace
+{
+// Below this many bytes per chunk the text is not worth splitting further
+constexpr std::size_t kMinChunkBytes = std::size_t{1} << 18;
+
+// Everything one line-aligned chunk contributed, with endpoints exactly as written in the file
+struct ChunkResult
+{
+    std::vector<std::pair<VertexId, VertexId>> edges;
+    std::uint64_t maxVertex = 0;
+    bool dimacsEdges = false; // saw "e u v" lines
+    bool plainEdges = false;  // saw bare "u v" lines
+    bool problemLine = false;
+    std::uint64_t problemVertices = 0;
+    const char *error = nullptr;
+    std::size_t errorOffset = 0;
+};
+
+void parseChunk(std::string_view text, std::size_t begin, std::size_t end, ChunkResult &out)
+{
+    const char *p = text.data() + begin;
+    const char *last = text.data() + end;
+    auto skipBlanks = [&]
+    {
+        while (p < last && (*p == ' ' || *p == '\t' || *p == '\r'))
+            ++p;
+    };
+    auto skipLine = [&]
+    {
+        p = static_cast<const char *>(std::memchr(p, '\n', last - p));
+        p = p ? p + 1 : last;
+    };
+    // Vertex ids must fit VertexId, so anything longer fails instead of overflowing
+    auto parseNumber = [&](std::uint64_t &value)
+    {
+        skipBlanks();
+        if (p == last || *p < '0' || *p > '9')
+            return false;
+        value = 0;
+        for (; p < last && *p >= '0' && *p <= '9'; ++p)
+        {
+            value = value * 10 + static_cast<std::uint64_t>(*p - '0');
+            if (value > UINT32_MAX)
+                return false;
+        }
+        return true;
+    };
+
+    while (p < last)
+    {
+        const char *line = p;
+        skipBlanks();
+        if (p == last)
+            break;
+        char head = *p;
+        std::uint64_t a = 0, b = 0;
+        if (head == '\n' || head == 'c' || head == '#' || head == '%')
+        {
+            skipLine();
+            continue;
+        }
+        if (head == 'p')
+        {
+            ++p;
+            skipBlanks();
+            // Format word ("edge", "col", ...), then vertex and edge counts
+            while (p < last && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')
+                ++p;
+            std::uint64_t m = 0;
+            if (out.problemLine || !parseNumber(out.problemVertices) || !parseNumber(m))
+            {
+                out.error = out.problemLine ? "Repeated DIMACS problem line" : "Malformed DIMACS problem line";
+                out.errorOffset = static_cast<std::size_t>(line - text.data());
+                return;
+            }
+            out.problemLine = true;
+        }
+        else if (head == 'e')
+        {
+            ++p;
+            if (!parseNumber(a) || !parseNumber(b) || a == 0 || b == 0)
+            {
+                out.error = "Malformed DIMACS edge line";
+                out.errorOffset = static_cast<std::size_t>(line - text.data());
+                return;
+            }
+            out.dimacsEdges = true;
+            out.edges.emplace_back(static_cast<VertexId>(a), static_cast<VertexId>(b));
+            out.maxVertex = std::max(out.maxVertex, std::max(a, b));
+        }
+        else
+        {
+            if (!parseNumber(a) || !parseNumber(b))
+            {
+                out.error = "Malformed edge line";
+                out.errorOffset = static_cast<std::size_t>(line - text.data());
+                return;
+            }
+            out.plainEdges = true;
+            out.edges.emplace_back(static_cast<VertexId>(a), static_cast<VertexId>(b));
+            out.maxVertex = std::max(out.maxVertex, std::max(a, b));
+        }
+        // Anything after the fields (weights, trailing comments) is ignored
+        skipLine();
+    }
+}
+
+std::size_t lineNumberAt(std::string_view text, std::size_t offset)
+{
+    return 1 + static_cast<std::size_t>(std::count(text.begin(), text.begin() + offset, '\n'));
+}
+}
+
+#if GRAPH_IO_MMAP
+MappedFile::MappedFile(const std::string &path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("Cannot open " + path);
+    struct stat info;
+    if (::fstat(fd, &info) != 0)
+    {
+        ::close(fd);
+        throw std::runtime_error("Cannot stat " + path);
+    }
+    size_ = static_cast<std::size_t>(info.st_size);
+    if (size_ > 0)
+    {
+        void *data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED)
+        {
+            ::close(fd);
+            throw std::runtime_error("Cannot map " + path);
+        }
+        // Chunks are parsed concurrently from different offsets, so ask for everything up front
+        ::madvise(data, size_, MADV_WILLNEED);
+        data_ = static_cast<const char *>(data);
+    }
+    // The mapping stays valid after the descriptor is closed
+    ::close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    if (data_)
+        ::munmap(const_cast<char *>(data_), size_);
+}
+#else
+MappedFile::MappedFile(const std::string &path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        throw std::runtime_error("Cannot open " + path);
+    contents_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    data_ = contents_.data();
+    size_ = contents_.size();
+}
+
+MappedFile::~MappedFile() = default;
+#endif
+
+Graph parseGraph(std::string_view text, unsigned numThreads)
+{
+    ThreadPool pool(numThreads);
+
+    // Line-aligned chunks: each boundary is moved just past the next newline
+    std::size_t numChunks = std::clamp<std::size_t>(text.size() / kMinChunkBytes, 1, std::size_t{pool.size()} * 4);
+    std::vector<std::size_t> bounds(numChunks + 1, text.size());
+    bounds[0] = 0;
+    for (std::size_t i = 1; i < numChunks; ++i)
+    {
+        std::size_t at = std::max(bounds[i - 1], i * (text.size() / numChunks));
+        std::size_t newline = text.find('\n', at);
+        bounds[i] = newline == std::string_view::npos ? text.size() : newline + 1;
+    }
+    std::vector<ChunkResult> chunks(numChunks);
+    pool.parallelFor(numChunks, [&](std::size_t begin, std::size_t end, unsigned)
+                     {
+        for (std::size_t i = begin; i < end; ++i)
+            parseChunk(text, bounds[i], bounds[i + 1], chunks[i]); });
+
+    bool dimacs = false, plain = false, problemLine = false;
+    std::uint64_t numVertices = 0, maxVertex = 0;
+    std::size_t totalEdges = 0;
+    for (const ChunkResult &chunk : chunks)
+    {
+        if (chunk.error)
+            throw std::runtime_error(std::string(chunk.error) + " on line " + std::to_string(lineNumberAt(text, chunk.errorOffset)));
+        if (chunk.problemLine && problemLine)
+            throw std::runtime_error("Repeated DIMACS problem line");
+        if (chunk.problemLine)
+            numVertices = chunk.problemVertices;
+        problemLine |= chunk.problemLine;
+        dimacs |= chunk.problemLine || chunk.dimacsEdges;
+        plain |= chunk.plainEdges;
+        maxVertex = std::max(maxVertex, chunk.maxVertex);
+        totalEdges += chunk.edges.size();
+    }
+    if (dimacs && plain)
+        throw std::runtime_error("Mixed DIMACS \"e u v\" and plain \"u v\" edge lines");
+    // DIMACS input declares its size; a plain edge list is sized by its largest id, so it needs an edge
+    if (dimacs && !problemLine)
+        throw std::runtime_error("Missing DIMACS problem line");
+    if (!dimacs && totalEdges == 0)
+        throw std::runtime_error("No DIMACS problem line or edges in the input");
+    // DIMACS ids are 1-based
+    const VertexId base = dimacs ? 1 : 0;
+    if (!problemLine)
+        numVertices = maxVertex + 1;
+    else if (totalEdges > 0 && maxVertex > numVertices)
+        throw std::runtime_error("Edge endpoint " + std::to_string(maxVertex) + " exceeds the " + std::to_string(numVertices) + " vertices of the problem line");
+    if (numVertices > UINT32_MAX || totalEdges > UINT32_MAX / 2)
+        throw std::runtime_error("Graph too large for 32-bit vertex ids and offsets");
+
+    // Bucket every edge under its lower endpoint, then sort and deduplicate each bucket
+    const std::size_t n = static_cast<std::size_t>(numVertices);
+    std::vector<EdgeOffset> bucketStart(n + 1, 0);
+    for (const ChunkResult &chunk : chunks)
+    {
+        for (const auto &[a, b] : chunk.edges)
+            ++bucketStart[std::min(a, b) - base + 1];
+    }
+    for (std::size_t v = 0; v < n; ++v)
+        bucketStart[v + 1] += bucketStart[v];
+    std::vector<VertexId> upper(totalEdges);
+    {
+        std::vector<EdgeOffset> cursor(bucketStart.begin(), bucketStart.end() - 1);
+        for (const ChunkResult &chunk : chunks)
+        {
+            for (const auto &[a, b] : chunk.edges)
+                upper[cursor[std::min(a, b) - base]++] = std::max(a, b) - base;
+        }
+    }
+    chunks.clear();
+    chunks.shrink_to_fit();
+
+    std::vector<EdgeOffset> kept(n + 1, 0);
+    pool.parallelFor(n, [&](std::size_t begin, std::size_t end, unsigned)
+                     {
+        for (std::size_t v = begin; v < end; ++v)
+        {
+            auto first = upper.begin() + bucketStart[v];
+            auto last = upper.begin() + bucketStart[v + 1];
+            std::sort(first, last);
+            kept[v + 1] = static_cast<EdgeOffset>(std::unique(first, last) - first);
+        } });
+    for (std::size_t v = 0; v < n; ++v)
+        kept[v + 1] += kept[v];
+
+    // Buckets in vertex order give edges sorted by (a, b), which keeps every CSR row sorted
+    std::vector<std::pair<VertexId, VertexId>> edges(kept[n]);
+    pool.parallelFor(n, [&](std::size_t begin, std::size_t end, unsigned)
+                     {
+        for (std::size_t v = begin; v < end; ++v)
+        {
+            for (EdgeOffset i = 0; i < kept[v + 1] - kept[v]; ++i)
+                edges[kept[v] + i] = {static_cast<VertexId>(v), upper[bucketStart[v] + i]};
+        } });
+    return GraphBuilder(n, std::move(edges)).build();
+}
+
+Graph loadGraphFile(const std::string &path, unsigned numThreads)
+{
+    MappedFile file(path);
+    return parseGraph(file.view(), numThreads);
+}
+
+Graph readGraph(std::istream &in)
+{
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    return parseGraph(text);
+}
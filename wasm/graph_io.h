@@ -0,0 +1,39 @@
+#ifndef GRAPH_IO_H
+#define GRAPH_IO_H
+
+#include "graph.h"
+#include <istream>
+#include <string>
+#include <string_view>
+
+// Read-only view of a whole file: memory-mapped where the platform allows it, read into memory otherwise.
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string &path);
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    std::string_view view() const { return {data_ ? data_ : "", size_}; }
+
+private:
+    const char *data_ = nullptr;
+    std::size_t size_ = 0;
+    std::string contents_; // only used when the file cannot be mapped
+};
+
+// Parse DIMACS .col text ("p edge n m" / "e u v", 1-based, 'c' comments) or a plain "u v" edge list
+// (0-based, '#' and '%' comments). The text is split into line-aligned chunks parsed on numThreads
+// threads (0 = all cores). Edges are normalized to u <= v and repeated edges are merged, since many
+// published instances list every edge in both directions. DIMACS edges without a problem line,
+// and text with neither a problem line nor any edge, are rejected.
+Graph parseGraph(std::string_view text, unsigned numThreads = 0);
+
+// Map the file and parseGraph it.
+Graph loadGraphFile(const std::string &path, unsigned numThreads = 0);
+
+// Read the whole stream and parseGraph it.
+Graph readGraph(std::istream &in);
+
+#endif // GRAPH_IO_H
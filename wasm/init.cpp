@@ -1,5 +1,7 @@
 #include "init.h"
 #include "algorithms.h" // Include for complete types
+#include "background_solver.h"
+#include "preprocess.h"
 
 Init::Init(unsigned int seed)
     : rng_(seed)
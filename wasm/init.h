@@ -1,11 +1,18 @@
 #pragma once
+#include <cstdint>
 #include <random>
 #include <iostream>
 #include <memory>
+#include <string>
+#include <vector>
 
 // Forward declarations
 struct AlgorithmIterator;
 struct StateNode;
+struct VertexChange;
+class BackgroundSolver;
+class VertexMapping;
+class ExpandedColoring;
 
 struct Init
 {
@@ -23,6 +30,25 @@ struct GlobalState
     std::unique_ptr<AlgorithmIterator> algorithm;
     std::shared_ptr<StateNode> initialStateNode;
     int iterationCount = 0;
+    std::string annealingSchedule = "geometric"; // reused by reinitializeAlgorithm
+    bool kempeChains = false;                    // likewise
+    // Buffers behind algorithmStepN: the raw change log, the coalesced
+    // (vertex, oldColor, newColor, conflictsAfter) records handed to JS, and
+    // vertex -> record offset while coalescing (-1 otherwise)
+    std::vector<VertexChange> changeLog;
+    std::vector<int> stepDelta;
+    std::vector<int> deltaSlot;
+    std::vector<std::uint8_t> checkpointBytes; // backs the view returned by saveCheckpoint
+    // Owns the active iterator while it runs off the main thread (startBackgroundRun)
+    std::unique_ptr<BackgroundSolver> backgroundSolver;
+    // Set when the search graph was peeled or renumbered: colorings handed to JS are those of the
+    // original graph. The initial one is expanded once; the current one follows algorithmStepN
+    // change by change and is expanded again after any other call that changes the iterator.
+    std::shared_ptr<const VertexMapping> vertexMapping;
+    std::unique_ptr<ExpandedColoring> expandedInitial;
+    std::unique_ptr<ExpandedColoring> expandedCurrent;
+    bool expandedCurrentStale = true;
+    std::vector<VertexChange> expandedChangeLog; // algorithmStepN's log in original ids
 
     GlobalState();
     ~GlobalState(); // Custom destructor to handle incomplete types
@@ -0,0 +1,281 @@
+#include "initial_coloring.h"
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace
+{
+constexpr VertexId kUnmarked = UINT32_MAX;
+
+// Smallest color no colored neighbor of v uses. mark[c] == v flags c as taken; it needs
+// maxDegree + 1 entries, enough for any vertex.
+int firstFreeColor(const Graph &graph, VertexId v, const std::vector<int> &coloring, std::vector<VertexId> &mark)
+{
+    for (VertexId nbr : graph.neighbors(v))
+    {
+        if (nbr != v && coloring[nbr] >= 0)
+            mark[coloring[nbr]] = v;
+    }
+    int color = 0;
+    while (mark[color] == v)
+        ++color;
+    return color;
+}
+
+// Neighbors other than v itself
+int properDegree(const Graph &graph, VertexId v)
+{
+    int degree = 0;
+    for (VertexId nbr : graph.neighbors(v))
+        degree += nbr != v;
+    return degree;
+}
+
+struct SaturationEntry
+{
+    int uncoloredDegree;
+    VertexId vertex;
+};
+
+// Max-heap order: larger uncolored degree first, then the lower vertex id
+bool saturationEntryLess(const SaturationEntry &a, const SaturationEntry &b)
+{
+    if (a.uncoloredDegree != b.uncoloredDegree)
+        return a.uncoloredDegree < b.uncoloredDegree;
+    return a.vertex > b.vertex;
+}
+
+struct RlfEntry
+{
+    int excludedNeighbors;  // neighbors already barred from the class being built
+    int candidateNeighbors; // neighbors still eligible for it
+    VertexId vertex;
+};
+
+// Max-heap order: most excluded neighbors first, then fewest candidate neighbors, then the lower id
+bool rlfEntryLess(const RlfEntry &a, const RlfEntry &b)
+{
+    if (a.excludedNeighbors != b.excludedNeighbors)
+        return a.excludedNeighbors < b.excludedNeighbors;
+    if (a.candidateNeighbors != b.candidateNeighbors)
+        return a.candidateNeighbors > b.candidateNeighbors;
+    return a.vertex > b.vertex;
+}
+}
+
+InitialColoring parseInitialColoring(const std::string &name)
+{
+    if (name == "random")
+        return InitialColoring::Random;
+    if (name == "greedy")
+        return InitialColoring::Greedy;
+    if (name == "dsatur")
+        return InitialColoring::DSatur;
+    if (name == "rlf")
+        return InitialColoring::RLF;
+    throw std::invalid_argument("Unknown initial coloring: " + name);
+}
+
+std::vector<int> greedyColoring(const Graph &graph)
+{
+    const VertexId n = static_cast<VertexId>(graph.numVertices());
+    std::vector<VertexId> order(n);
+    std::iota(order.begin(), order.end(), VertexId{0});
+    std::stable_sort(order.begin(), order.end(), [&](VertexId a, VertexId b)
+                     { return graph.degree(a) > graph.degree(b); });
+
+    std::vector<int> coloring(n, -1);
+    std::vector<VertexId> mark(graph.maxDegree() + 1, kUnmarked);
+    for (VertexId v : order)
+        coloring[v] = firstFreeColor(graph, v, coloring, mark);
+    return coloring;
+}
+
+std::vector<int> dsaturColoring(const Graph &graph)
+{
+    const VertexId n = static_cast<VertexId>(graph.numVertices());
+    const std::size_t colorLimit = graph.maxDegree() + 1;
+    std::vector<int> coloring(n, -1);
+    std::vector<int> saturation(n, 0);
+    std::vector<int> uncoloredDegree(n);
+    // (vertex, color) pairs already counted in saturation
+    std::unordered_set<std::uint64_t> seenColors;
+    seenColors.reserve(graph.numEdges());
+
+    // Entries go stale when their vertex is colored or its counters move on; every change
+    // pushes a fresh entry, so the current one is always present and stale ones are skipped.
+    std::vector<std::vector<SaturationEntry>> buckets(colorLimit);
+    for (VertexId v = 0; v < n; ++v)
+    {
+        uncoloredDegree[v] = properDegree(graph, v);
+        buckets[0].push_back({uncoloredDegree[v], v});
+    }
+    std::make_heap(buckets[0].begin(), buckets[0].end(), saturationEntryLess);
+    auto push = [&](VertexId v)
+    {
+        auto &bucket = buckets[saturation[v]];
+        bucket.push_back({uncoloredDegree[v], v});
+        std::push_heap(bucket.begin(), bucket.end(), saturationEntryLess);
+    };
+
+    std::vector<VertexId> mark(colorLimit, kUnmarked);
+    int top = 0;
+    for (VertexId colored = 0; colored < n; ++colored)
+    {
+        VertexId v = kUnmarked;
+        while (v == kUnmarked)
+        {
+            auto &bucket = buckets[top];
+            if (bucket.empty())
+            {
+                --top;
+                continue;
+            }
+            SaturationEntry entry = bucket.front();
+            std::pop_heap(bucket.begin(), bucket.end(), saturationEntryLess);
+            bucket.pop_back();
+            if (coloring[entry.vertex] < 0 && saturation[entry.vertex] == top && uncoloredDegree[entry.vertex] == entry.uncoloredDegree)
+                v = entry.vertex;
+        }
+
+        int color = firstFreeColor(graph, v, coloring, mark);
+        coloring[v] = color;
+        for (VertexId nbr : graph.neighbors(v))
+        {
+            if (nbr == v || coloring[nbr] >= 0)
+                continue;
+            --uncoloredDegree[nbr];
+            if (seenColors.insert(static_cast<std::uint64_t>(nbr) * colorLimit + static_cast<std::uint64_t>(color)).second)
+                top = std::max(top, ++saturation[nbr]);
+            push(nbr);
+        }
+    }
+    return coloring;
+}
+
+std::vector<int> rlfColoring(const Graph &graph)
+{
+    enum : std::uint8_t
+    {
+        Candidate, // uncolored and not adjacent to the class being built
+        Excluded,  // uncolored but adjacent to it; waits for a later class
+        Colored
+    };
+    const VertexId n = static_cast<VertexId>(graph.numVertices());
+    std::vector<int> coloring(n, -1);
+    std::vector<std::uint8_t> status(n);
+    std::vector<int> excludedNeighbors(n), candidateNeighbors(n);
+    std::vector<RlfEntry> heap;
+    std::vector<VertexId> newlyExcluded;
+
+    auto addToClass = [&](VertexId v, int color)
+    {
+        coloring[v] = color;
+        status[v] = Colored;
+        newlyExcluded.clear();
+        for (VertexId nbr : graph.neighbors(v))
+        {
+            if (status[nbr] == Candidate)
+            {
+                status[nbr] = Excluded;
+                newlyExcluded.push_back(nbr);
+            }
+        }
+        for (VertexId u : newlyExcluded)
+        {
+            for (VertexId x : graph.neighbors(u))
+            {
+                if (status[x] != Candidate)
+                    continue;
+                ++excludedNeighbors[x];
+                --candidateNeighbors[x];
+                heap.push_back({excludedNeighbors[x], candidateNeighbors[x], x});
+                std::push_heap(heap.begin(), heap.end(), rlfEntryLess);
+            }
+        }
+    };
+
+    VertexId remaining = n;
+    for (int color = 0; remaining > 0; ++color)
+    {
+        for (VertexId v = 0; v < n; ++v)
+        {
+            status[v] = coloring[v] < 0 ? Candidate : Colored;
+            excludedNeighbors[v] = 0;
+        }
+        VertexId first = kUnmarked;
+        for (VertexId v = 0; v < n; ++v)
+        {
+            if (status[v] != Candidate)
+                continue;
+            candidateNeighbors[v] = 0;
+            for (VertexId nbr : graph.neighbors(v))
+                candidateNeighbors[v] += nbr != v && status[nbr] == Candidate;
+            if (first == kUnmarked || candidateNeighbors[v] > candidateNeighbors[first])
+                first = v;
+        }
+
+        // The class starts from the candidate with the most candidate neighbors; after that the
+        // heap always yields the candidate with the most excluded neighbors
+        heap.clear();
+        addToClass(first, color);
+        --remaining;
+        for (VertexId v = 0; v < n; ++v)
+        {
+            if (status[v] == Candidate)
+                heap.push_back({excludedNeighbors[v], candidateNeighbors[v], v});
+        }
+        std::make_heap(heap.begin(), heap.end(), rlfEntryLess);
+        while (!heap.empty())
+        {
+            RlfEntry entry = heap.front();
+            std::pop_heap(heap.begin(), heap.end(), rlfEntryLess);
+            heap.pop_back();
+            VertexId v = entry.vertex;
+            if (status[v] != Candidate || excludedNeighbors[v] != entry.excludedNeighbors || candidateNeighbors[v] != entry.candidateNeighbors)
+                continue;
+            addToClass(v, color);
+            --remaining;
+        }
+    }
+    return coloring;
+}
+
+std::vector<int> constructiveColoring(const Graph &graph, InitialColoring method)
+{
+    switch (method)
+    {
+    case InitialColoring::Greedy:
+        return greedyColoring(graph);
+    case InitialColoring::DSatur:
+        return dsaturColoring(graph);
+    case InitialColoring::RLF:
+        return rlfColoring(graph);
+    default:
+        throw std::invalid_argument("Not a constructive initial coloring");
+    }
+}
+
+int dropLastColor(const Graph &graph, std::vector<int> &coloring, int numColors)
+{
+    if (numColors <= 1)
+        return numColors;
+    const int last = numColors - 1;
+    std::vector<int> neighborsWithColor(last, 0);
+    for (VertexId v = 0; v < graph.numVertices(); ++v)
+    {
+        if (coloring[v] != last)
+            continue;
+        // Vertices recolored earlier in this pass already count under their new color
+        for (VertexId nbr : graph.neighbors(v))
+        {
+            if (nbr != v && coloring[nbr] < last)
+                ++neighborsWithColor[coloring[nbr]];
+        }
+        coloring[v] = static_cast<int>(std::min_element(neighborsWithColor.begin(), neighborsWithColor.end()) - neighborsWithColor.begin());
+        std::fill(neighborsWithColor.begin(), neighborsWithColor.end(), 0);
+    }
+    return last;
+}
@@ -0,0 +1,46 @@
+#ifndef INITIAL_COLORING_H
+#define INITIAL_COLORING_H
+
+#include "graph.h"
+#include <string>
+#include <vector>
+
+// How the start coloring of a search is built
+enum class InitialColoring
+{
+    Random, // uniform over a maxDegree + 1 palette
+    Greedy, // first fit in order of decreasing degree (Welsh-Powell)
+    DSatur, // most distinct neighbor colors first, ties to the larger uncolored degree
+    RLF     // recursive largest first: one maximal independent set per color
+};
+
+// "random", "greedy", "dsatur" or "rlf"
+InitialColoring parseInitialColoring(const std::string &name);
+
+struct InitialColoringOptions
+{
+    InitialColoring method = InitialColoring::Random;
+    // Constructive methods only: drop the last color class of their k-coloring and start the
+    // search at k - 1 colors, so it begins a few conflicts away from an improvement instead of
+    // at a proper coloring it cannot improve on
+    bool oneColorFewer = false;
+};
+
+// The constructive colorings return colors 0..k-1, all used. Self-loops are ignored, since
+// they conflict under every color.
+
+// O(V log V + E)
+std::vector<int> greedyColoring(const Graph &graph);
+// O((V + E) log V): a bucket per saturation level, each a max-heap on uncolored degree
+std::vector<int> dsaturColoring(const Graph &graph);
+// O(k (V + E) log V): each class is grown from a lazy max-heap on neighbors already excluded
+std::vector<int> rlfColoring(const Graph &graph);
+
+// Dispatch to one of the three above; throws for InitialColoring::Random
+std::vector<int> constructiveColoring(const Graph &graph, InitialColoring method);
+
+// Recolor every vertex of color numColors - 1 to its least conflicting color below it; returns
+// the new color count. Colorings with a single color are returned unchanged.
+int dropLastColor(const Graph &graph, std::vector<int> &coloring, int numColors);
+
+#endif // INITIAL_COLORING_H
@@ -0,0 +1,96 @@
+#include "portfolio.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+// Same graph and palette as the initial state, with every vertex recolored uniformly at random
+std::unique_ptr<StateNode> randomStartState(const StateNode &initialState, std::mt19937 &rng)
+{
+    ColoringArray coloring(initialState.coloring.size());
+    UsedColorsArray usedColors(initialState.palette.size(), 0);
+    std::uniform_int_distribution<int> colorDist(0, static_cast<int>(initialState.palette.size()) - 1);
+    for (int &c : coloring)
+    {
+        c = colorDist(rng);
+        usedColors[c]++;
+    }
+    int conflicts = computeConflicts(*initialState.graph, coloring);
+    return std::make_unique<StateNode>(initialState.graph, initialState.palette, std::move(coloring), conflicts, std::move(usedColors));
+}
+}
+
+PortfolioResult runPortfolio(const StateNode &initialState, const PortfolioOptions &options)
+{
+    if (options.entries.empty())
+        throw std::invalid_argument("Portfolio needs at least one entry");
+
+    PortfolioResult result;
+    result.runs.resize(options.entries.size());
+    std::atomic<bool> solved{false};
+    std::mutex bestMutex;
+    int bestConflicts = INT_MAX;
+    const int interval = std::max(1, options.checkInterval);
+
+    unsigned numThreads = options.numThreads ? options.numThreads : std::max(1u, std::thread::hardware_concurrency());
+    numThreads = static_cast<unsigned>(std::min<std::size_t>(numThreads, options.entries.size()));
+    ThreadPool pool(numThreads);
+    pool.parallelFor(options.entries.size(), [&](std::size_t begin, std::size_t end, unsigned)
+                     {
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            const PortfolioEntry &entry = options.entries[i];
+            PortfolioRun &run = result.runs[i];
+            if (solved.load(std::memory_order_relaxed))
+            {
+                run.cancelled = true;
+                continue;
+            }
+            std::mt19937 rng(entry.seed);
+            auto start = options.randomStart ? randomStartState(initialState, rng) : std::make_unique<StateNode>(initialState);
+            // Runs already occupy the cores, so parallel iterators get a single thread each
+            auto algorithm = initializeAlgorithm(std::move(start), entry.algorithmName, options.iterations, rng, 1);
+            int sinceCheck = 0;
+            while (algorithm->step())
+            {
+                if (++sinceCheck == interval)
+                {
+                    sinceCheck = 0;
+                    if (solved.load(std::memory_order_relaxed))
+                    {
+                        run.cancelled = true;
+                        break;
+                    }
+                }
+            }
+            run.conflicts = algorithm->currentConflicts();
+            run.iterations = algorithm->currentIteration();
+            run.stats = algorithm->searchStats();
+
+            std::lock_guard<std::mutex> lock(bestMutex);
+            if (run.conflicts < bestConflicts || (run.conflicts == bestConflicts && i < result.winner))
+            {
+                bestConflicts = run.conflicts;
+                result.winner = i;
+                result.state = std::make_unique<StateNode>(algorithm->getState());
+            }
+            if (run.conflicts == 0)
+                solved.store(true, std::memory_order_relaxed);
+        } });
+    return result;
+}
+
+std::vector<PortfolioEntry> makePortfolioEntries(const std::vector<std::string> &algorithmNames, std::size_t n, std::mt19937 &rng)
+{
+    if (algorithmNames.empty())
+        throw std::invalid_argument("Portfolio needs at least one algorithm");
+    std::vector<PortfolioEntry> entries;
+    entries.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+        entries.push_back(PortfolioEntry{algorithmNames[i % algorithmNames.size()], static_cast<unsigned int>(rng())});
+    return entries;
+}
@@ -0,0 +1,53 @@
+#ifndef PORTFOLIO_H
+#define PORTFOLIO_H
+
+#include "algorithms.h"
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// One independent run of a portfolio: which iterator to use and the seed for its start and search.
+struct PortfolioEntry
+{
+    std::string algorithmName;
+    unsigned int seed;
+};
+
+struct PortfolioOptions
+{
+    std::vector<PortfolioEntry> entries;
+    int iterations = 0;
+    // Worker threads; 0 runs every entry on its own thread, up to the number of cores
+    unsigned numThreads = 0;
+    // Redraw each run's start coloring from its seed over the same palette, instead of
+    // starting every run from the given coloring
+    bool randomStart = true;
+    // Steps between checks of the shared stop flag
+    int checkInterval = 1024;
+};
+
+struct PortfolioRun
+{
+    int conflicts = -1;
+    int iterations = 0;
+    // Stopped early because another run reached zero conflicts
+    bool cancelled = false;
+    SearchStats stats;
+};
+
+struct PortfolioResult
+{
+    std::size_t winner = 0; // index into PortfolioOptions::entries
+    std::unique_ptr<StateNode> state;
+    std::vector<PortfolioRun> runs;
+};
+
+// Run every entry concurrently over the initial state's shared graph. The run with the fewest
+// conflicts wins (ties go to the lower index); the first run to reach zero conflicts stops the rest.
+PortfolioResult runPortfolio(const StateNode &initialState, const PortfolioOptions &options);
+
+// n entries cycling through algorithmNames, with seeds drawn from rng
+std::vector<PortfolioEntry> makePortfolioEntries(const std::vector<std::string> &algorithmNames, std::size_t n, std::mt19937 &rng);
+
+#endif // PORTFOLIO_H
@@ -0,0 +1,322 @@
+#include "preprocess.h"
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+namespace
+{
+std::size_t properDegree(const Graph &graph, VertexId v)
+{
+    std::size_t degree = 0;
+    for (VertexId nbr : graph.neighbors(v))
+        degree += nbr != v;
+    return degree;
+}
+
+// Vertices by decreasing degree, ties to the lower id
+std::vector<VertexId> byDecreasingDegree(const Graph &graph)
+{
+    std::vector<VertexId> order(graph.numVertices());
+    std::iota(order.begin(), order.end(), VertexId{0});
+    std::stable_sort(order.begin(), order.end(), [&](VertexId a, VertexId b)
+                     { return graph.degree(a) > graph.degree(b); });
+    return order;
+}
+
+// Breadth-first over every component, each started from the next unvisited entry of roots. With
+// byDegree set the children of a vertex are queued by increasing degree (Cuthill-McKee).
+std::vector<VertexId> breadthFirst(const Graph &graph, const std::vector<VertexId> &roots, bool byDegree)
+{
+    const std::size_t n = graph.numVertices();
+    std::vector<VertexId> order;
+    order.reserve(n);
+    std::vector<char> visited(n, 0);
+    for (VertexId root : roots)
+    {
+        if (visited[root])
+            continue;
+        visited[root] = 1;
+        order.push_back(root);
+        for (std::size_t head = order.size() - 1; head < order.size(); ++head)
+        {
+            const std::size_t firstChild = order.size();
+            for (VertexId nbr : graph.neighbors(order[head]))
+            {
+                if (!visited[nbr])
+                {
+                    visited[nbr] = 1;
+                    order.push_back(nbr);
+                }
+            }
+            if (byDegree)
+            {
+                std::stable_sort(order.begin() + static_cast<std::ptrdiff_t>(firstChild), order.end(), [&](VertexId a, VertexId b)
+                                 { return graph.degree(a) < graph.degree(b); });
+            }
+        }
+    }
+    return order;
+}
+}
+
+VertexOrder parseVertexOrder(const std::string &name)
+{
+    if (name == "original")
+        return VertexOrder::Original;
+    if (name == "degree")
+        return VertexOrder::Degree;
+    if (name == "rcm")
+        return VertexOrder::RCM;
+    if (name == "bfs")
+        return VertexOrder::BFS;
+    throw std::invalid_argument("Unknown vertex order: " + name);
+}
+
+std::vector<VertexId> vertexOrder(const Graph &graph, VertexOrder order)
+{
+    switch (order)
+    {
+    case VertexOrder::Original:
+    {
+        std::vector<VertexId> identity(graph.numVertices());
+        std::iota(identity.begin(), identity.end(), VertexId{0});
+        return identity;
+    }
+    case VertexOrder::Degree:
+        return byDecreasingDegree(graph);
+    case VertexOrder::RCM:
+    {
+        // Components start from their lowest degree vertex, a cheap stand-in for a peripheral one
+        std::vector<VertexId> roots = byDecreasingDegree(graph);
+        std::reverse(roots.begin(), roots.end());
+        std::vector<VertexId> result = breadthFirst(graph, roots, true);
+        std::reverse(result.begin(), result.end());
+        return result;
+    }
+    case VertexOrder::BFS:
+        return breadthFirst(graph, byDecreasingDegree(graph), false);
+    }
+    throw std::invalid_argument("Unknown vertex order");
+}
+
+Graph inducedSubgraph(const Graph &graph, std::span<const VertexId> vertices)
+{
+    constexpr VertexId kDropped = UINT32_MAX;
+    std::vector<VertexId> newId(graph.numVertices(), kDropped);
+    for (std::size_t i = 0; i < vertices.size(); ++i)
+        newId[vertices[i]] = static_cast<VertexId>(i);
+
+    std::vector<EdgeOffset> offsets(vertices.size() + 1, 0);
+    std::vector<VertexId> targets;
+    targets.reserve(graph.targets().size());
+    for (std::size_t i = 0; i < vertices.size(); ++i)
+    {
+        const std::size_t begin = targets.size();
+        for (VertexId nbr : graph.neighbors(vertices[i]))
+        {
+            if (newId[nbr] != kDropped)
+                targets.push_back(newId[nbr]);
+        }
+        std::sort(targets.begin() + static_cast<std::ptrdiff_t>(begin), targets.end());
+        offsets[i + 1] = static_cast<EdgeOffset>(targets.size());
+    }
+    targets.shrink_to_fit();
+    return Graph(std::move(offsets), std::move(targets));
+}
+
+std::vector<VertexId> peelLowDegree(const Graph &graph, int k, std::vector<char> &removed)
+{
+    const std::size_t n = graph.numVertices();
+    const std::size_t threshold = static_cast<std::size_t>(std::max(k, 0));
+    std::vector<std::size_t> degree(n);
+    removed.assign(n, 0);
+    // Doubles as the work queue: vertices are marked removed when queued, processed in order
+    std::vector<VertexId> peeled;
+    for (VertexId v = 0; v < n; ++v)
+    {
+        degree[v] = properDegree(graph, v);
+        if (degree[v] < threshold)
+        {
+            removed[v] = 1;
+            peeled.push_back(v);
+        }
+    }
+    for (std::size_t head = 0; head < peeled.size(); ++head)
+    {
+        const VertexId v = peeled[head];
+        for (VertexId nbr : graph.neighbors(v))
+        {
+            if (nbr == v || removed[nbr])
+                continue;
+            if (--degree[nbr] < threshold)
+            {
+                removed[nbr] = 1;
+                peeled.push_back(nbr);
+            }
+        }
+    }
+    return peeled;
+}
+
+VertexMapping::VertexMapping(std::shared_ptr<Graph> original, std::vector<VertexId> toOriginal, std::vector<VertexId> peeled, int peelColors)
+    : original_(std::move(original)), toOriginal_(std::move(toOriginal)), peeled_(std::move(peeled)), peelColors_(peelColors)
+{
+    peelRank_.assign(original_->numVertices(), static_cast<int>(peeled_.size()));
+    for (std::size_t i = 0; i < peeled_.size(); ++i)
+        peelRank_[peeled_[i]] = static_cast<int>(i);
+}
+
+ExpandedColoring::ExpandedColoring(std::shared_ptr<const VertexMapping> mapping)
+    : mapping_(std::move(mapping))
+{
+    const std::size_t n = mapping_->original()->numVertices();
+    coloring_.assign(n, 0);
+    queued_.assign(n, 0);
+    pending_.reserve(mapping_->peeled().size());
+}
+
+int ExpandedColoring::peeledColor(VertexId v)
+{
+    const Graph &graph = *mapping_->original();
+    const int rank = mapping_->peelRank(v);
+    for (VertexId nbr : graph.neighbors(v))
+    {
+        if (mapping_->peelRank(nbr) > rank)
+            ++neighborColors_[coloring_[nbr]];
+    }
+    // A free color, if any, comes within the first (higher ranked degree + 1) entries; without
+    // one every entry is in use, so the full scan is no longer than the neighbor list either
+    int color = 0;
+    while (color < numColors_ && neighborColors_[color] > 0)
+        ++color;
+    if (color == numColors_)
+        color = static_cast<int>(std::min_element(neighborColors_.begin(), neighborColors_.end()) - neighborColors_.begin());
+    for (VertexId nbr : graph.neighbors(v))
+    {
+        if (mapping_->peelRank(nbr) > rank)
+            neighborColors_[coloring_[nbr]] = 0;
+    }
+    return color;
+}
+
+void ExpandedColoring::schedule(VertexId v)
+{
+    const int rank = mapping_->peelRank(v);
+    auto byRank = [this](VertexId a, VertexId b)
+    { return mapping_->peelRank(a) < mapping_->peelRank(b); };
+    for (VertexId nbr : mapping_->original()->neighbors(v))
+    {
+        if (mapping_->peelRank(nbr) < rank && !queued_[nbr])
+        {
+            queued_[nbr] = 1;
+            pending_.push_back(nbr);
+            std::push_heap(pending_.begin(), pending_.end(), byRank);
+        }
+    }
+}
+
+void ExpandedColoring::assign(const ColoringArray &searchColoring, int numColors)
+{
+    numColors_ = std::max(numColors, 1);
+    neighborColors_.assign(static_cast<std::size_t>(numColors_), 0);
+    std::span<const VertexId> toOriginal = mapping_->toOriginal();
+    for (std::size_t v = 0; v < toOriginal.size(); ++v)
+        coloring_[toOriginal[v]] = searchColoring[v];
+    std::span<const VertexId> peeled = mapping_->peeled();
+    for (auto it = peeled.rbegin(); it != peeled.rend(); ++it)
+        coloring_[*it] = peeledColor(*it);
+}
+
+void ExpandedColoring::apply(const VertexChange &change, std::vector<VertexChange> &changes)
+{
+    const VertexId vertex = mapping_->toOriginal()[change.vertex];
+    changes.push_back(VertexChange{vertex, coloring_[vertex], change.newColor, change.conflictsAfter});
+    coloring_[vertex] = change.newColor;
+    if (mapping_->peeled().empty())
+        return;
+    // Higher ranks first: a vertex is then recomputed once, after every neighbor it depends on
+    auto byRank = [this](VertexId a, VertexId b)
+    { return mapping_->peelRank(a) < mapping_->peelRank(b); };
+    schedule(vertex);
+    while (!pending_.empty())
+    {
+        std::pop_heap(pending_.begin(), pending_.end(), byRank);
+        const VertexId v = pending_.back();
+        pending_.pop_back();
+        queued_[v] = 0;
+        const int color = peeledColor(v);
+        if (color == coloring_[v])
+            continue;
+        changes.push_back(VertexChange{v, coloring_[v], color, change.conflictsAfter});
+        coloring_[v] = color;
+        schedule(v);
+    }
+}
+
+PreparedSearch prepareSearch(std::shared_ptr<Graph> graph, std::mt19937 &rng, const InitialColoringOptions &initial, const PreprocessOptions &options)
+{
+    const bool constructive = initial.method != InitialColoring::Random;
+    if (options.peel && !constructive)
+        throw std::invalid_argument("Peeling needs a constructive initial coloring");
+    if (options.order == VertexOrder::Original && !options.peel)
+        return {initialStateNode(std::move(graph), rng, initial), nullptr};
+
+    ColoringArray coloring;
+    int numColors = 0;
+    if (constructive)
+    {
+        coloring = constructiveColoring(*graph, initial.method);
+        numColors = coloring.empty() ? 1 : *std::max_element(coloring.begin(), coloring.end()) + 1;
+        if (initial.oneColorFewer)
+            numColors = dropLastColor(*graph, coloring, numColors);
+    }
+
+    std::vector<VertexId> peeled;
+    std::vector<VertexId> kept;
+    if (options.peel)
+    {
+        std::vector<char> removed;
+        peeled = peelLowDegree(*graph, numColors, removed);
+        kept.reserve(graph->numVertices() - peeled.size());
+        for (VertexId v = 0; v < graph->numVertices(); ++v)
+        {
+            if (!removed[v])
+                kept.push_back(v);
+        }
+    }
+    else
+    {
+        kept.resize(graph->numVertices());
+        std::iota(kept.begin(), kept.end(), VertexId{0});
+    }
+
+    // Order the vertices that are left, then renumber them in one pass
+    std::vector<VertexId> toOriginal;
+    if (options.order == VertexOrder::Original)
+    {
+        toOriginal = std::move(kept);
+    }
+    else
+    {
+        Graph core = inducedSubgraph(*graph, kept);
+        toOriginal = vertexOrder(core, options.order);
+        for (VertexId &v : toOriginal)
+            v = kept[v];
+    }
+    auto searchGraph = std::make_shared<Graph>(inducedSubgraph(*graph, toOriginal));
+
+    StateNode state;
+    if (constructive)
+    {
+        ColoringArray restricted(toOriginal.size());
+        for (std::size_t v = 0; v < toOriginal.size(); ++v)
+            restricted[v] = coloring[toOriginal[v]];
+        state = stateFromColoring(std::move(searchGraph), ColorPalette(numColors), std::move(restricted));
+    }
+    else
+    {
+        state = initialStateNode(std::move(searchGraph), rng, initial);
+    }
+    auto mapping = std::make_shared<VertexMapping>(std::move(graph), std::move(toOriginal), std::move(peeled), options.peel ? numColors : 0);
+    return {std::move(state), std::move(mapping)};
+}
@@ -0,0 +1,116 @@
+#ifndef PREPROCESS_H
+#define PREPROCESS_H
+
+#include "algorithms.h"
+#include <memory>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+// Numbering of the graph the search runs on. Generators and files number vertices arbitrarily, so
+// the neighbors scanned in the hot loops are scattered over the coloring array; the orders below
+// put adjacent vertices at nearby ids.
+enum class VertexOrder
+{
+    Original, // keep the input numbering
+    Degree,   // decreasing degree: the most scanned vertices share cache lines
+    RCM,      // reverse Cuthill-McKee: small bandwidth, neighbors close to each other
+    BFS       // breadth-first from the highest degree vertex of each component
+};
+
+// "original", "degree", "rcm" or "bfs"
+VertexOrder parseVertexOrder(const std::string &name);
+
+// Every vertex once; position i of the result becomes vertex i of the renumbered graph
+std::vector<VertexId> vertexOrder(const Graph &graph, VertexOrder order);
+
+// Subgraph induced by `vertices`, vertices[i] renumbered to i, every neighbor list sorted
+Graph inducedSubgraph(const Graph &graph, std::span<const VertexId> vertices);
+
+// Set aside, recursively, the vertices with fewer than k neighbors left, and return them in the
+// order they were removed. Whatever colors the rest gets from a k-color palette, they can be
+// colored back in reverse order without a conflict, since each then has at most k - 1 colored
+// neighbors. Self-loops do not count.
+std::vector<VertexId> peelLowDegree(const Graph &graph, int k, std::vector<char> &removed);
+
+struct PreprocessOptions
+{
+    VertexOrder order = VertexOrder::Original;
+    // Peel with k = the palette size of the start coloring. Needs a constructive initial coloring:
+    // a random start has maxDegree + 1 colors, which would peel every vertex.
+    bool peel = false;
+};
+
+// How the search graph relates to the original one. Immutable, so a solver thread can share it.
+class VertexMapping
+{
+public:
+    VertexMapping(std::shared_ptr<Graph> original, std::vector<VertexId> toOriginal, std::vector<VertexId> peeled, int peelColors);
+
+    const std::shared_ptr<Graph> &original() const { return original_; }
+    // Search vertex -> original vertex
+    std::span<const VertexId> toOriginal() const { return toOriginal_; }
+    // Original ids of the peeled vertices, in peel order
+    std::span<const VertexId> peeled() const { return peeled_; }
+    // The k the graph was peeled with (0 if it was not); palettes of the search must not go below it
+    int peelColors() const { return peelColors_; }
+    // Index of an original vertex in peel order, peeled().size() for vertices of the search graph.
+    // Peeled vertices are colored in decreasing rank, each after its higher ranked neighbors.
+    int peelRank(VertexId v) const { return peelRank_[v]; }
+
+private:
+    std::shared_ptr<Graph> original_;
+    std::vector<VertexId> toOriginal_;
+    std::vector<VertexId> peeled_;
+    std::vector<int> peelRank_;
+    int peelColors_;
+};
+
+// Coloring of the original graph behind a search coloring: the search colors moved to their
+// original ids, then the peeled vertices in decreasing rank, each on the first color none of its
+// higher ranked neighbors has, or the least used among them if the palette has shrunk below
+// peelColors. Kept current one search recolor at a time, so following a search costs what the
+// search changes rather than a full expansion per read.
+class ExpandedColoring
+{
+public:
+    explicit ExpandedColoring(std::shared_ptr<const VertexMapping> mapping);
+
+    // Expand a whole search coloring. O(V + E).
+    void assign(const ColoringArray &searchColoring, int numColors);
+    // Apply one recolor of the search coloring (search ids), appending it and every peeled vertex
+    // it recolors to `changes`, in original ids and with the same conflictsAfter. Costs the degree
+    // of each vertex touched: the recolored one and the peeled vertices whose color is recomputed.
+    // The result is exactly what assign() would give.
+    void apply(const VertexChange &change, std::vector<VertexChange> &changes);
+
+    const ColoringArray &coloring() const { return coloring_; }
+    const VertexMapping &mapping() const { return *mapping_; }
+
+private:
+    // Color of peeled vertex v given its higher ranked neighbors
+    int peeledColor(VertexId v);
+    // Queue v's lower ranked peeled neighbors for recomputation
+    void schedule(VertexId v);
+
+    std::shared_ptr<const VertexMapping> mapping_;
+    ColoringArray coloring_;
+    int numColors_ = 0;
+    std::vector<int> neighborColors_; // per color, zero between calls
+    std::vector<VertexId> pending_;   // max-heap on peel rank
+    std::vector<char> queued_;
+};
+
+struct PreparedSearch
+{
+    StateNode state;                        // start of the search, over the search graph
+    std::shared_ptr<const VertexMapping> mapping; // null when the search graph is the original one
+};
+
+// initialStateNode plus the preprocessing stage. A constructive start is computed on the whole
+// graph and restricted to the search graph, so the stage never changes the colors it starts from.
+// With the original order and no peeling this is exactly initialStateNode.
+PreparedSearch prepareSearch(std::shared_ptr<Graph> graph, std::mt19937 &rng, const InitialColoringOptions &initial, const PreprocessOptions &options);
+
+#endif // PREPROCESS_H
@@ -0,0 +1,78 @@
+#include "stats.h"
+#include <cstdlib>
+#include <new>
+#include <sstream>
+
+#if GRAPH_COLORING_STATS
+namespace
+{
+thread_local AllocationCounts allocationsOnThread;
+
+void *countedAllocate(std::size_t size)
+{
+    ++allocationsOnThread.count;
+    allocationsOnThread.bytes += size;
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+}
+
+// Replacing the global allocation functions is what lets steps report their allocations;
+// the array and nothrow forms forward here by default
+void *operator new(std::size_t size) { return countedAllocate(size); }
+void *operator new[](std::size_t size) { return countedAllocate(size); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+
+AllocationCounts threadAllocations() { return allocationsOnThread; }
+#else
+AllocationCounts threadAllocations() { return {}; }
+#endif
+
+SearchStats &SearchStats::operator+=(const SearchStats &other)
+{
+    selectionNs += other.selectionNs;
+    evaluationNs += other.evaluationNs;
+    commitNs += other.commitNs;
+    kLeastNs += other.kLeastNs;
+    stepNs += other.stepNs;
+    steps += other.steps;
+    movesEvaluated += other.movesEvaluated;
+    movesAccepted += other.movesAccepted;
+    allocations += other.allocations;
+    bytesAllocated += other.bytesAllocated;
+    bytesCopied += other.bytesCopied;
+    return *this;
+}
+
+std::string SearchStats::toJson() const
+{
+    auto perStep = [&](std::uint64_t total)
+    {
+        return steps ? static_cast<double>(total) / static_cast<double>(steps) : 0.0;
+    };
+    std::ostringstream out;
+    out << "{\"enabled\": " << (kStatsEnabled ? "true" : "false")
+        << ", \"steps\": " << steps
+        << ", \"selectionNs\": " << selectionNs
+        << ", \"evaluationNs\": " << evaluationNs
+        << ", \"commitNs\": " << commitNs
+        << ", \"kLeastNs\": " << kLeastNs
+        << ", \"stepNs\": " << stepNs
+        << ", \"movesEvaluated\": " << movesEvaluated
+        << ", \"movesAccepted\": " << movesAccepted
+        << ", \"allocations\": " << allocations
+        << ", \"bytesAllocated\": " << bytesAllocated
+        << ", \"bytesCopied\": " << bytesCopied
+        << ", \"perStep\": {\"selectionNs\": " << perStep(selectionNs)
+        << ", \"evaluationNs\": " << perStep(evaluationNs)
+        << ", \"commitNs\": " << perStep(commitNs)
+        << ", \"kLeastNs\": " << perStep(kLeastNs)
+        << ", \"stepNs\": " << perStep(stepNs)
+        << ", \"movesEvaluated\": " << perStep(movesEvaluated)
+        << ", \"allocations\": " << perStep(allocations) << "}}";
+    return out.str();
+}
@@ -0,0 +1,124 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Per-phase timers and counters for the step() hot paths. Off by default: configure with
+// -DGRAPH_COLORING_STATS=ON (or define GRAPH_COLORING_STATS=1) to collect them. When off,
+// SearchStats stays all zeros and every hook below compiles to nothing.
+#ifndef GRAPH_COLORING_STATS
+#define GRAPH_COLORING_STATS 0
+#endif
+
+constexpr bool kStatsEnabled = GRAPH_COLORING_STATS != 0;
+
+struct SearchStats
+{
+    // Wall time of each phase, in nanoseconds
+    std::uint64_t selectionNs = 0;  // picking the vertex to recolor (selectNextNode and friends)
+    std::uint64_t evaluationNs = 0; // scoring candidate colors
+    std::uint64_t commitNs = 0;     // applying accepted moves (StateNode::forward, beam rebuild)
+    std::uint64_t kLeastNs = 0;     // beam top-k selection
+    std::uint64_t stepNs = 0;       // whole step() calls, phases included
+
+    std::uint64_t steps = 0;
+    std::uint64_t movesEvaluated = 0; // (vertex, color) candidates scored
+    std::uint64_t movesAccepted = 0;
+    std::uint64_t allocations = 0; // operator new calls made while stepping
+    std::uint64_t bytesAllocated = 0;
+    std::uint64_t bytesCopied = 0; // state copied wholesale: snapshots, materialized beam states, move lists
+
+    SearchStats &operator+=(const SearchStats &other);
+    // One JSON object with every counter plus per-step averages of the timers
+    std::string toJson() const;
+};
+
+struct AllocationCounts
+{
+    std::uint64_t count = 0;
+    std::uint64_t bytes = 0;
+};
+
+// operator new calls made by the calling thread so far; always zero when stats are off
+AllocationCounts threadAllocations();
+
+inline void countStat(std::uint64_t &counter, std::uint64_t amount = 1)
+{
+    if constexpr (kStatsEnabled)
+        counter += amount;
+}
+
+#if GRAPH_COLORING_STATS
+// Adds the lifetime of the scope to total
+class PhaseTimer
+{
+public:
+    explicit PhaseTimer(std::uint64_t &total) : total_(total), start_(std::chrono::steady_clock::now()) {}
+    ~PhaseTimer()
+    {
+        total_ += static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count());
+    }
+    PhaseTimer(const PhaseTimer &) = delete;
+    PhaseTimer &operator=(const PhaseTimer &) = delete;
+
+private:
+    std::uint64_t &total_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Adds the heap allocations the calling thread makes during the scope to stats. Pool workers
+// other than worker 0 (the thread already inside a StepScope) use one around their share.
+class AllocationScope
+{
+public:
+    explicit AllocationScope(SearchStats &stats, bool active = true) : stats_(stats), active_(active), start_(threadAllocations()) {}
+    ~AllocationScope()
+    {
+        if (!active_)
+            return;
+        AllocationCounts now = threadAllocations();
+        stats_.allocations += now.count - start_.count;
+        stats_.bytesAllocated += now.bytes - start_.bytes;
+    }
+    AllocationScope(const AllocationScope &) = delete;
+    AllocationScope &operator=(const AllocationScope &) = delete;
+
+private:
+    SearchStats &stats_;
+    bool active_;
+    AllocationCounts start_;
+};
+
+// One step(): counts it, times it and attributes its allocations on the calling thread
+class StepScope
+{
+public:
+    explicit StepScope(SearchStats &stats) : timer_(stats.stepNs), allocations_(stats) { ++stats.steps; }
+
+private:
+    PhaseTimer timer_;
+    AllocationScope allocations_;
+};
+#else
+class PhaseTimer
+{
+public:
+    explicit PhaseTimer(std::uint64_t &) {}
+};
+
+class AllocationScope
+{
+public:
+    explicit AllocationScope(SearchStats &, bool = true) {}
+};
+
+class StepScope
+{
+public:
+    explicit StepScope(SearchStats &) {}
+};
+#endif
+
+#endif // STATS_H
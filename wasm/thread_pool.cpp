@@ -0,0 +1,98 @@
+#include "thread_pool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned numThreads)
+{
+#if GRAPH_COLORING_THREADS
+    if (numThreads == 0)
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    workers_.reserve(numThreads - 1);
+    for (unsigned worker = 1; worker < numThreads; ++worker)
+        workers_.emplace_back([this, worker]
+                              { workerLoop(worker); });
+#else
+    (void)numThreads;
+#endif
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto &worker : workers_)
+        worker.join();
+}
+
+void ThreadPool::runRange(unsigned worker)
+{
+    std::size_t begin = count_ * worker / size();
+    std::size_t end = count_ * (worker + 1) / size();
+    if (begin == end)
+        return;
+    try
+    {
+        (*body_)(begin, end, worker);
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!error_)
+            error_ = std::current_exception();
+    }
+}
+
+void ThreadPool::workerLoop(unsigned worker)
+{
+    std::uint64_t seen = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&]
+                       { return stopping_ || generation_ != seen; });
+            if (stopping_)
+                return;
+            seen = generation_;
+        }
+        runRange(worker);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--pending_ == 0)
+                done_.notify_one();
+        }
+    }
+}
+
+void ThreadPool::parallelFor(std::size_t count, RangeBody body)
+{
+    if (count == 0)
+        return;
+    if (workers_.empty() || count == 1)
+    {
+        body(0, count, 0);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        body_ = &body;
+        count_ = count;
+        pending_ = static_cast<unsigned>(workers_.size());
+        error_ = nullptr;
+        ++generation_;
+    }
+    wake_.notify_all();
+    runRange(0);
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [&]
+                   { return pending_ == 0; });
+        body_ = nullptr;
+        error = error_;
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
@@ -0,0 +1,76 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Native builds always have threads; Emscripten only when compiled with -pthread.
+#if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
+#define GRAPH_COLORING_THREADS 1
+#else
+#define GRAPH_COLORING_THREADS 0
+#endif
+
+// Non-owning reference to a parallelFor body. The body only has to outlive the call, so unlike
+// std::function nothing is copied and no capture list is ever heap-allocated.
+class RangeBody
+{
+public:
+    template <typename F>
+        requires(!std::is_same_v<std::remove_cvref_t<F>, RangeBody> && std::is_invocable_v<F &, std::size_t, std::size_t, unsigned>)
+    RangeBody(F &&body)
+        : object_(const_cast<void *>(static_cast<const void *>(std::addressof(body)))),
+          call_([](void *object, std::size_t begin, std::size_t end, unsigned worker)
+                { (*static_cast<std::remove_reference_t<F> *>(object))(begin, end, worker); })
+    {
+    }
+
+    void operator()(std::size_t begin, std::size_t end, unsigned worker) const { call_(object_, begin, end, worker); }
+
+private:
+    void *object_;
+    void (*call_)(void *, std::size_t, std::size_t, unsigned);
+};
+
+// Fixed set of worker threads for fork-join loops. The calling thread takes part as
+// worker 0, so a pool of size 1 (or a build without threads) simply runs inline.
+class ThreadPool
+{
+public:
+    // numThreads == 0 picks std::thread::hardware_concurrency()
+    explicit ThreadPool(unsigned numThreads = 0);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(workers_.size()) + 1; }
+
+    // Split [0, count) into size() contiguous ranges and run body(begin, end, worker) for each.
+    // Range boundaries depend only on count and size(); returns once every range is done and
+    // rethrows the first exception raised by any of them.
+    void parallelFor(std::size_t count, RangeBody body);
+
+private:
+    void workerLoop(unsigned worker);
+    void runRange(unsigned worker);
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const RangeBody *body_ = nullptr;
+    std::size_t count_ = 0;
+    std::uint64_t generation_ = 0;
+    unsigned pending_ = 0;
+    bool stopping_ = false;
+    std::exception_ptr error_;
+};
+
+#endif // THREAD_POOL_H